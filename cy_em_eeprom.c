@@ -18,6 +18,7 @@
 *******************************************************************************/
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 #include "cy_em_eeprom.h"
@@ -29,6 +30,81 @@
 static mtb_block_storage_t _mtb_emeeprom_bsd;
 //Global RAM buffer to avoid stack corruption */
 static uint32_t writeRamBuffer[CY_EM_EEPROM_MAXIMUM_ROW_SIZE / 4];
+/* Global row read cache. Entries are looked up by the row address and are valid
+ * within one Em_EEPROM operation only. A zero last use stamp marks an empty entry.
+ */
+static uint32_t rowCacheData[CY_EM_EEPROM_ROW_CACHE_ENTRIES][CY_EM_EEPROM_MAXIMUM_ROW_SIZE / 4];
+static uint32_t rowCacheAddr[CY_EM_EEPROM_ROW_CACHE_ENTRIES];
+static uint32_t rowCacheLastUse[CY_EM_EEPROM_ROW_CACHE_ENTRIES];
+static uint32_t rowCacheUseCount;
+
+#if (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u)
+/* The bytes of the ongoing read already found in the active headers, one bit per byte */
+static uint32_t readCoverage[(CY_EM_EEPROM_READ_BITMAP_SIZE + 31u) / 32u];
+#endif /* (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u) */
+
+#if (CPUSS_FLASHC_ECT == 1)
+/* The blank check results of the rows, valid within one Em_EEPROM operation only.
+ * The entries are selected by the row index, so the rows of a window of the ring
+ * do not evict each other.
+ */
+#define CY_EM_EEPROM_ROW_STATE_ENTRIES      (32u)
+#define CY_EM_EEPROM_ROW_STATE_UNKNOWN      (0u)
+#define CY_EM_EEPROM_ROW_STATE_BLANK        (1u)
+#define CY_EM_EEPROM_ROW_STATE_WRITTEN      (2u)
+static uint32_t rowStateAddr[CY_EM_EEPROM_ROW_STATE_ENTRIES];
+static uint8_t rowState[CY_EM_EEPROM_ROW_STATE_ENTRIES];
+#endif /* (CPUSS_FLASHC_ECT == 1) */
+
+#if (CY_EM_EEPROM_STATS_ENABLE == 1u)
+/* The statistics of the context used by the ongoing Em_EEPROM operation */
+static cy_stc_em_eeprom_stats_t* activeStats;
+
+#define CY_EM_EEPROM_STATS_ADD(field, value)    \
+    do { if (NULL != activeStats) { activeStats->field += (value); } } while (0)
+
+/* Adds the time passed since startTime to the specified statistics field */
+#define CY_EM_EEPROM_STATS_ADD_TIME(field, startTime) \
+    CY_EM_EEPROM_STATS_ADD(field, (uint32_t)(CY_EM_EEPROM_STATS_TIMESTAMP() - (startTime)))
+#else
+#define CY_EM_EEPROM_STATS_ADD(field, value)            do { } while (0)
+#define CY_EM_EEPROM_STATS_ADD_TIME(field, startTime)   ((void)(startTime))
+#endif /* (CY_EM_EEPROM_STATS_ENABLE == 1u) */
+
+#if (CY_EM_EEPROM_TRACE_ENABLE == 1u)
+/* Reports the block device operation started at startTime to the application */
+#define CY_EM_EEPROM_TRACE(op, addr, length, startTime) \
+    Cy_Em_EEPROM_TraceHook((op), (addr), (length), \
+                           (uint32_t)(CY_EM_EEPROM_STATS_TIMESTAMP() - (startTime)))
+#else
+#define CY_EM_EEPROM_TRACE(op, addr, length, startTime) ((void)(startTime))
+#endif /* (CY_EM_EEPROM_TRACE_ENABLE == 1u) */
+
+#if (CY_EM_EEPROM_FIXED_GEOMETRY == 1u)
+/* The geometry of the hot paths is fixed at compile time, so the divisions by it fold
+ * to constants and shifts. Cy_Em_EEPROM_Init_BD() accepts the matching configuration only.
+ */
+#define CY_EM_EEPROM_ROW_SIZE(context)      (CY_EM_EEPROM_FIXED_ROW_SIZE)
+#define CY_EM_EEPROM_BYTE_IN_ROW(context)   (CY_EM_EEPROM_FIXED_ROW_SIZE / 2u)
+#define CY_EM_EEPROM_NUM_ROWS(context)      (CY_EM_EEPROM_FIXED_NUMBER_OF_ROWS)
+#define CY_EM_EEPROM_RING_ROWS(context)     (CY_EM_EEPROM_FIXED_WEAR_LEVELING_ROWS)
+/* The divisions by the constants are optimized by the compiler, so no shifts are used */
+#define CY_EM_EEPROM_ROW_SIZE_SHIFT(context)    (0u)
+#define CY_EM_EEPROM_BYTE_IN_ROW_SHIFT(context) (0u)
+#define CY_EM_EEPROM_NUM_ROWS_SHIFT(context)    (0u)
+#define CY_EM_EEPROM_RING_MULTIPLE(context)     \
+    (0u == (CY_EM_EEPROM_FIXED_WEAR_LEVELING_ROWS % CY_EM_EEPROM_FIXED_NUMBER_OF_ROWS))
+#else
+#define CY_EM_EEPROM_ROW_SIZE(context)      ((context)->rowSize)
+#define CY_EM_EEPROM_BYTE_IN_ROW(context)   ((context)->byteInRow)
+#define CY_EM_EEPROM_NUM_ROWS(context)      ((context)->numberOfRows)
+#define CY_EM_EEPROM_RING_ROWS(context)     ((context)->wearLevelingRows)
+/* The geometry derived by Cy_Em_EEPROM_Init_BD() */
+#define CY_EM_EEPROM_ROW_SIZE_SHIFT(context)    ((uint32_t)(context)->rowSizeShift)
+#define CY_EM_EEPROM_BYTE_IN_ROW_SHIFT(context) ((uint32_t)(context)->byteInRowShift)
+#define CY_EM_EEPROM_NUM_ROWS_SHIFT(context)    ((uint32_t)(context)->numberOfRowsShift)
+#define CY_EM_EEPROM_RING_MULTIPLE(context)     (0u != (context)->ringMultipleOfRows)
+#endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 1u) */
 
 /*******************************************************************************
 * Private Function Prototypes
@@ -37,40 +113,151 @@ static cy_en_em_eeprom_status_t ReadSimpleMode(uint32_t addr, void* eepromData,
                                                const cy_stc_eeprom_context_t* context);
 static cy_en_em_eeprom_status_t ReadExtendedMode(uint32_t addr, void* eepromData, uint32_t size,
                                                  cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t ReadOldestFirst(uint32_t addr, void* eepromData, uint32_t size,
+                                                cy_stc_eeprom_context_t* context);
+#if (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u)
+static cy_en_em_eeprom_status_t ReadNewestFirst(uint32_t addr, void* eepromData, uint32_t size,
+                                                cy_stc_eeprom_context_t* context);
+static uint32_t GetUncoveredRun(uint32_t* start, uint32_t end);
+static void SetCovered(uint32_t start, uint32_t length);
+#endif /* (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u) */
+static const uint8_t* GetSimpleModePtr(uint32_t addr, uint32_t size,
+                                       const cy_stc_eeprom_context_t* context);
+static const uint8_t* GetExtendedModePtr(uint32_t addr, uint32_t size,
+                                         cy_en_em_eeprom_status_t* ptrResult,
+                                         cy_stc_eeprom_context_t* context);
 static cy_en_em_eeprom_status_t WriteSimpleMode(uint32_t addr, const void* eepromData,
                                                 uint32_t size,
                                                 cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t WriteDeltaSimpleMode(uint32_t addr, const void* eepromData,
+                                                     uint32_t size,
+                                                     cy_stc_eeprom_context_t* context);
 static cy_en_em_eeprom_status_t WriteExtendedMode(uint32_t addr, const void* eepromData,
                                                   uint32_t size,
                                                   cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t WriteDeltaExtendedMode(uint32_t addr, const void* eepromData,
+                                                       uint32_t size,
+                                                       cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t WriteImageExtendedMode(const uint8_t* eepromData,
+                                                       cy_stc_eeprom_context_t* context);
 static uint8_t CalcChecksum(const uint8_t rowData[], uint32_t len);
+static cy_rslt_t BdRead(uint32_t addr, uint32_t size, uint8_t* data,
+                        const cy_stc_eeprom_context_t* context);
+static cy_rslt_t BdProgramRow(uint32_t rowAddr, const uint32_t* rowData,
+                              const cy_stc_eeprom_context_t* context);
+static cy_rslt_t BdEraseRow(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
 static cy_en_em_eeprom_status_t CheckRanges(const cy_stc_eeprom_config2_t* config,
                                             const cy_stc_eeprom_context_t* context);
-static cy_en_em_eeprom_status_t WriteRow(uint32_t* const rowAddr, const uint32_t* rowData,
+static cy_en_em_eeprom_status_t WriteRow(uint32_t rowAddr, const uint32_t* rowData,
                                          const cy_stc_eeprom_context_t* context);
-static cy_en_em_eeprom_status_t EraseRow(const uint32_t* rowAddr, const uint32_t* ramBuffAddr,
+static cy_en_em_eeprom_status_t EraseRow(uint32_t rowAddr, const uint32_t* ramBuffAddr,
                                          const cy_stc_eeprom_context_t* context);
 static uint32_t CalculateRowChecksum(const uint32_t* ptrRow, uint32_t rowSize);
 static uint32_t GetStoredRowChecksum(const uint32_t* ptrRow);
 static cy_en_em_eeprom_status_t CheckRowChecksum(const uint32_t* ptrRow, uint32_t rowSize);
-static uint32_t GetStoredSeqNum(const uint32_t* ptrRow);
+static uint64_t GetStoredSeqNum(const uint32_t* ptrRow);
+static void SetSeqNum(uint32_t* ptrRow, uint64_t seqNum);
 static cy_en_em_eeprom_status_t DefineLastWrittenRow(cy_stc_eeprom_context_t* context);
-static cy_en_em_eeprom_status_t CheckLastWrittenRowIntegrity(uint32_t* ptrSeqNum,
+static cy_en_em_eeprom_status_t CheckLastWrittenRowIntegrity(uint64_t* ptrSeqNum,
                                                              cy_stc_eeprom_context_t* context);
-static uint32_t* GetNextRowPointer(uint32_t* ptrRow, const cy_stc_eeprom_context_t* context);
-static uint32_t* GetReadRowPointer(uint32_t* ptrRow, const cy_stc_eeprom_context_t* context);
-static cy_en_em_eeprom_status_t CopyHistoricData(uint32_t* ptrRowWrite, uint32_t* ptrRow,
+static uint32_t GetNextRowAddr(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static uint32_t GetReadRowAddr(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static uint32_t GetPrevRowAddr(uint32_t rowAddr, uint32_t numRowsBack,
+                               const cy_stc_eeprom_context_t* context);
+static uint32_t GetRedundantRowAddr(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static uint32_t GetRowWriteCount(uint32_t rowIndex, uint64_t seqNum,
+                                 const cy_stc_eeprom_context_t* context);
+static uint32_t GetHistoricSlot(uint32_t rowAddr, uint64_t seqNum,
+                                const cy_stc_eeprom_context_t* context);
+static const uint32_t* ReadRow(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static void StartOperation(cy_stc_eeprom_context_t* context);
+static void InvalidateRowCache(void);
+static const uint32_t* ReadRedundantRow(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t ScrubRow(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static void InvalidateCachedRow(uint32_t rowAddr);
+static uint64_t ReadStoredSeqNum(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static bool IsRowErased(const uint32_t* ptrRow);
+static uint32_t GetLayoutId(const cy_stc_eeprom_context_t* context);
+static bool IsInLayout(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static uint32_t GetLayoutEndAddr(const cy_stc_eeprom_context_t* context);
+static uint32_t GetRingRowAddr(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static bool IsInWindow(uint32_t rowAddr, uint32_t firstRowAddr, uint32_t numRows,
+                       const cy_stc_eeprom_context_t* context);
+static uint64_t ReadValidSeqNum(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t MigrateExtendedMode(cy_stc_eeprom_context_t* oldContext,
+                                                    cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t PlaceMigrationRows(uint32_t* firstRowAddr,
+                                                   cy_stc_eeprom_context_t* oldContext,
+                                                   const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t WriteMigrationRows(uint32_t firstRowAddr, uint32_t firstRow,
+                                                   uint64_t baseSeqNum,
+                                                   cy_stc_eeprom_context_t* oldContext,
+                                                   const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t EraseOtherLayoutRows(const cy_stc_eeprom_context_t* oldContext,
+                                                     const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t CopyHistoricData(uint32_t* ptrRowWrite, uint32_t rowAddr,
                                                  const cy_stc_eeprom_context_t* context);
-static cy_en_em_eeprom_status_t CopyHeadersData(uint32_t* ptrRowWrite, uint32_t* ptrRow,
+static cy_en_em_eeprom_status_t CopyHeadersData(uint32_t* ptrRowWrite, uint32_t rowAddr,
                                                 const cy_stc_eeprom_context_t* context);
 static uint32_t GetPhysicalSize(const cy_stc_eeprom_context_t* context,
                                 const cy_stc_eeprom_config2_t* config);
 static void ComputeEEPROMProgramSize(cy_stc_eeprom_context_t* context);
+static void ComputeGeometry(cy_stc_eeprom_context_t* context);
+static uint8_t GetPowerOfTwoShift(uint32_t value);
+static uint32_t DivideFast(uint32_t value, uint32_t divisor, uint32_t shift);
+static uint32_t RemainderFast(uint32_t value, uint32_t divisor, uint32_t shift);
+static uint32_t GetRowIndex(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static void GetHeaderData(const uint32_t* ptrRow, uint32_t offset, uint8_t* data, uint32_t size,
+                          const cy_stc_eeprom_context_t* context);
+static void ExpandHeaderData(const uint8_t* packedData, uint32_t packedSize, uint32_t offset,
+                             uint8_t* data, uint32_t size);
+#if (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u)
+static uint32_t CompressHeaderData(const uint8_t* data, uint32_t size, uint8_t* packedData,
+                                   uint32_t packedSize);
+static uint32_t GetRunLength(const uint8_t* data, uint32_t size);
+#endif /* (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u) */
+
+static const cy_stc_em_eeprom_region_t* FindRegion(uint32_t addr, uint32_t size,
+                                                   const cy_stc_em_eeprom_region_t* regions,
+                                                   uint32_t numRegions, uint32_t* partSize);
+static cy_en_em_eeprom_status_t MergeRegionStatus(cy_en_em_eeprom_status_t result,
+                                                  cy_en_em_eeprom_status_t partResult);
+
+#if (CY_EM_EEPROM_KV_ENABLE == 1u)
+static cy_stc_em_eeprom_kv_entry_t* KvFindEntry(uint16_t key, uint32_t size,
+                                                const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvWrite(uint32_t addr, const void* data, uint32_t size,
+                                        cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvWriteRecordHeader(uint32_t addr, uint16_t key, uint32_t size,
+                                                    cy_stc_eeprom_context_t* context);
+static cy_stc_em_eeprom_kv_entry_t* KvFindSlot(uint32_t size, uint32_t minAddr,
+                                               const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvAddRecord(uint16_t key, const void* data, uint32_t srcAddr,
+                                            uint32_t size, uint32_t minAddr,
+                                            cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvCompact(cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvRelocateRecord(cy_stc_em_eeprom_kv_entry_t* record,
+                                                 uint32_t minAddr,
+                                                 cy_stc_eeprom_context_t* context);
+static cy_stc_em_eeprom_kv_entry_t* KvFindMovableRecord(uint32_t holeIndex,
+                                                        const cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvMoveRecord(cy_stc_em_eeprom_kv_entry_t* entry,
+                                             cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvSwapRecord(cy_stc_em_eeprom_kv_entry_t* entry,
+                                             cy_stc_eeprom_context_t* context);
+static cy_en_em_eeprom_status_t KvCopyValue(uint32_t dstAddr, uint32_t srcAddr, uint32_t size,
+                                            cy_stc_eeprom_context_t* context);
+static bool KvIsValueEqual(uint32_t addr, const void* data, uint32_t size,
+                           cy_stc_eeprom_context_t* context);
+static void KvSetRecordHeader(uint8_t* recordHeader, uint16_t key, uint32_t size);
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
 
 #if (CPUSS_FLASHC_ECT == 1)
 static bool WorkFlashIsErased(
-    const uint32_t* addr,
+    uint32_t addr,
     uint32_t size);
+static bool WorkFlashRowIsErased(uint32_t rowAddr, const cy_stc_eeprom_context_t* context);
+static void SetRowState(uint32_t rowAddr, uint8_t state, const cy_stc_eeprom_context_t* context);
 #endif
 /*******************************************************************************
 *       Functions
@@ -99,6 +286,7 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Init(
         config_new.redundantCopy = config->redundantCopy;
         config_new.blockingWrite = config->blockingWrite;
         config_new.userNvmStartAddr = config->userFlashStartAddr;
+        config_new.wearLevelingRows = 0u;
 
         result = Cy_Em_EEPROM_Init_BD(&config_new, context, &_mtb_emeeprom_bsd);
     }
@@ -121,6 +309,7 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Init_BD(
     {
         /* Intialize the context to 0's */
         memset(context, 0, sizeof(cy_stc_eeprom_context_t));
+        StartOperation(context);
 
 
         context->bd = block_device;
@@ -161,20 +350,56 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Init_BD(
         }
         #endif /* !defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED) */
 
+        #if (CY_EM_EEPROM_FIXED_GEOMETRY == 1u)
+        if (CY_RSLT_SUCCESS == result)
+        {
+            /* Only the configuration of the geometry fixed at compile time is valid */
+            if ((0u != context->simpleMode) ||
+                (CY_EM_EEPROM_FIXED_ROW_SIZE != context->rowSize) ||
+                (CY_EM_EEPROM_FIXED_EEPROM_SIZE != context->eepromSize) ||
+                (CY_EM_EEPROM_FIXED_WEAR_LEVELING_ROWS != ((0u == config->wearLevelingFactor) ?
+                                                           config->wearLevelingRows :
+                                                           (context->numberOfRows *
+                                                            config->wearLevelingFactor))))
+            {
+                result = CY_EM_EEPROM_BAD_PARAM;
+            }
+        }
+        #endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 1u) */
+
         if (CY_RSLT_SUCCESS == result)
         {
             /* Copies the user's config structure fields into the context */
             if (0u != context->simpleMode)
             {
                 context->wearLevelingFactor = 1u;
+                context->wearLevelingRows = context->numberOfRows;
                 context->redundantCopy = 0u;
             }
             else
             {
-                context->wearLevelingFactor = config->wearLevelingFactor;
+                if (0u == config->wearLevelingFactor)
+                {
+                    /* Keeps the whole number of wear-leveling blocks for reference */
+                    context->wearLevelingRows = config->wearLevelingRows;
+                    context->wearLevelingFactor =
+                        (uint8_t)(((config->wearLevelingRows / context->numberOfRows) <
+                                   CY_EM_EEPROM_MAX_WEAR_LEVELING_FACTOR) ?
+                                  (config->wearLevelingRows / context->numberOfRows) :
+                                  CY_EM_EEPROM_MAX_WEAR_LEVELING_FACTOR);
+                }
+                else
+                {
+                    context->wearLevelingFactor = config->wearLevelingFactor;
+                    context->wearLevelingRows = context->numberOfRows *
+                                                config->wearLevelingFactor;
+                }
                 context->redundantCopy = config->redundantCopy;
+                /* The rows get the layout id only from Cy_Em_EEPROM_Migrate() on */
+                context->layoutId = 0u;
             }
             context->blockingWrite = config->blockingWrite;
+            ComputeGeometry(context);
 
             /* Initialize the Last written row */
             (void)DefineLastWrittenRow(context);
@@ -195,10 +420,13 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Read(
     cy_stc_eeprom_context_t* context)
 {
     cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
 
     /* Validates the input parameters */
     if ((0u != size) && ((addr + size) <= (context->eepromSize)) && (NULL != eepromData))
     {
+        StartOperation(context);
+        CY_EM_EEPROM_STATS_ADD(numReads, 1u);
         if (0u != context->simpleMode)
         {
             result =
@@ -208,6 +436,7 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Read(
         {
             result = ReadExtendedMode(addr, eepromData, size, context);
         }
+        CY_EM_EEPROM_STATS_ADD_TIME(timeRead, startTime);
     }
 
     return result;
@@ -244,7 +473,7 @@ static cy_en_em_eeprom_status_t ReadSimpleMode(
 {
     cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
     #if (CPUSS_FLASHC_ECT == 1)
-    if (WorkFlashIsErased((uint32_t*)(context->userNvmStartAddr + addr), size))
+    if (WorkFlashIsErased(context->userNvmStartAddr + addr, size))
     {
         /* Fills the RAM buffer with flash data for the case when not a whole row is requested to be
            overwritten */
@@ -254,9 +483,8 @@ static cy_en_em_eeprom_status_t ReadSimpleMode(
     else
     #endif /* (CPUSS_FLASHC_ECT == 1) */
     {
-        cy_rslt_t readResult = context->bd->read(context->bd->context,
-                                                 (context->userNvmStartAddr + addr), size,
-                                                 (uint8_t*)eepromData);
+        cy_rslt_t readResult = BdRead((context->userNvmStartAddr + addr), size,
+                                      (uint8_t*)eepromData, context);
         result = (readResult == CY_RSLT_SUCCESS) ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_BAD_DATA;
     }
     return result;
@@ -268,6 +496,8 @@ static cy_en_em_eeprom_status_t ReadSimpleMode(
 ****************************************************************************//**
 *
 * Reads data from a specified location when Simple Mode is disabled.
+* The reads of up to CY_EM_EEPROM_READ_BITMAP_SIZE bytes stop at the newest
+* headers holding the data.
 *
 * \param addr
 * The logical start address in the Em_EEPROM storage to start reading data from.
@@ -291,28 +521,315 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
     uint32_t size,
     cy_stc_eeprom_context_t* context)
 {
+    cy_en_em_eeprom_status_t result;
+
+    #if (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u)
+    if (size <= CY_EM_EEPROM_READ_BITMAP_SIZE)
+    {
+        result = ReadNewestFirst(addr, eepromData, size, context);
+    }
+    else
+    #endif /* (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u) */
+    {
+        result = ReadOldestFirst(addr, eepromData, size, context);
+    }
+    return result;
+}
+
+
+#if (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u)
+/*******************************************************************************
+* Function Name: ReadNewestFirst
+****************************************************************************//**
+*
+* Reads data from a specified location when Simple Mode is disabled. Walks
+* the active headers from the newest one and takes each byte from the newest
+* header holding it. Stops when each byte is found. Reads the historic data
+* only for the bytes not held by any active header.
+*
+* \param addr
+* The logical start address in the Em_EEPROM storage to start reading data from.
+*
+* \param eepromData
+* The pointer to a user array to write data to.
+*
+* \param size
+* The amount of data to read in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* This function returns cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t ReadNewestFirst(
+    uint32_t addr,
+    void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
+    uint32_t byteInRow = CY_EM_EEPROM_BYTE_IN_ROW(context);
+    uint32_t numRows = CY_EM_EEPROM_NUM_ROWS(context);
+    uint32_t byteInRowShift = CY_EM_EEPROM_BYTE_IN_ROW_SHIFT(context);
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    cy_en_em_eeprom_status_t retHistoricCrc;
+    cy_en_em_eeprom_status_t crcStatus;
+    uint8_t* userBufferAddr_p = eepromData;
+    const uint32_t* ptrRowWork;
+    uint64_t seqNum;
+    uint32_t rowAddr;
+    uint32_t strHeadAddr;
+    uint32_t endHeadAddr;
+    uint32_t lastSlot;
+    uint32_t slot;
+    uint32_t start;
+    uint32_t end;
+    uint32_t runLength;
+    uint32_t numUncovered = size;
+    uint32_t i;
+
+    /* 1. Clears the user buffer and the coverage of its bytes */
+    (void)memset(eepromData, 0, size);
+    (void)memset(readCoverage, 0, ((size + 31u) / 32u) * sizeof(readCoverage[0u]));
+
+    /* 2. Ensures the last written row is correct */
+    (void)CheckLastWrittenRowIntegrity(&seqNum, context);
+
+    /* 3. Reads data from the active headers, the newest first */
+    rowAddr = context->lastWrittenRowAddr;
+    for (i = 0u; (i < numRows) && (0u != numUncovered); i++)
+    {
+        ptrRowWork = ReadRow(rowAddr, context);
+        crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+        if ((CY_EM_EEPROM_SUCCESS != crcStatus) && (0u != context->redundantCopy))
+        {
+            ptrRowWork = ReadRedundantRow(rowAddr, context);
+            crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+        }
+
+        /* Skips the row if CRC is bad */
+        if (CY_EM_EEPROM_SUCCESS == crcStatus)
+        {
+            strHeadAddr = ptrRowWork[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32];
+            endHeadAddr = strHeadAddr + (ptrRowWork[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] &
+                                         CY_EM_EEPROM_HEADER_LEN_MASK);
+            if ((strHeadAddr < (addr + size)) && (endHeadAddr > addr))
+            {
+                /* Copies the bytes of the range not found in the newer headers */
+                start = (strHeadAddr > addr) ? (strHeadAddr - addr) : (0u);
+                end = ((endHeadAddr < (addr + size)) ? endHeadAddr : (addr + size)) - addr;
+                runLength = GetUncoveredRun(&start, end);
+                while (0u != runLength)
+                {
+                    GetHeaderData(ptrRowWork, (addr + start) - strHeadAddr,
+                                  &userBufferAddr_p[start], runLength, context);
+                    SetCovered(start, runLength);
+                    numUncovered -= runLength;
+                    start += runLength;
+                    runLength = GetUncoveredRun(&start, end);
+                }
+            }
+        }
+        rowAddr = GetPrevRowAddr(rowAddr, 1u, context);
+    }
+
+    /* 4. Reads the historic data of the bytes not found in the active headers */
+    lastSlot = GetHistoricSlot(context->lastWrittenRowAddr, seqNum, context);
+    start = 0u;
+    runLength = (0u != numUncovered) ? GetUncoveredRun(&start, size) : 0u;
+    while (0u != runLength)
+    {
+        slot = DivideFast(addr + start, byteInRow, byteInRowShift);
+        end = ((slot + 1u) * byteInRow) - addr;
+        end = (end < size) ? end : size;
+        rowAddr = GetPrevRowAddr(context->lastWrittenRowAddr,
+                                 RemainderFast((lastSlot + numRows) - slot, numRows,
+                                               CY_EM_EEPROM_NUM_ROWS_SHIFT(context)),
+                                 context);
+
+        retHistoricCrc = CY_EM_EEPROM_SUCCESS;
+        ptrRowWork = ReadRow(rowAddr, context);
+        if (CY_EM_EEPROM_SUCCESS != CheckRowChecksum(ptrRowWork, rowSize))
+        {
+            /* CRC is bad. Checks if the redundant copy if enabled */
+            retHistoricCrc = CY_EM_EEPROM_BAD_CHECKSUM;
+            if (0u != context->redundantCopy)
+            {
+                ptrRowWork = ReadRedundantRow(rowAddr, context);
+                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowWork, rowSize))
+                {
+                    retHistoricCrc = CY_EM_EEPROM_REDUNDANT_COPY_USED;
+                }
+            }
+        }
+
+        if (CY_EM_EEPROM_BAD_CHECKSUM != retHistoricCrc)
+        {
+            /* Copies the uncovered bytes of the slot, the historic data takes the second half
+             * of the row
+             */
+            runLength = GetUncoveredRun(&start, end);
+            while (0u != runLength)
+            {
+                (void)memcpy(&userBufferAddr_p[start],
+                             &((const uint8_t*)ptrRowWork)[byteInRow +
+                                                           ((addr + start) - (slot * byteInRow))],
+                             runLength);
+                start += runLength;
+                runLength = GetUncoveredRun(&start, end);
+            }
+        }
+        else if (IsRowErased(ptrRowWork))
+        {
+            /* The row that has never been written reads as zeros without an error */
+            retHistoricCrc = CY_EM_EEPROM_SUCCESS;
+        }
+        else
+        {
+            /* Reports zeros */
+        }
+
+        /* Reports the status of the CRC verification in the same order as ReadOldestFirst() */
+        if (CY_EM_EEPROM_BAD_CHECKSUM == retHistoricCrc)
+        {
+            result = CY_EM_EEPROM_BAD_CHECKSUM;
+        }
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            result = retHistoricCrc;
+        }
+
+        start = end;
+        runLength = GetUncoveredRun(&start, size);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: GetUncoveredRun
+****************************************************************************//**
+*
+* Finds the next run of the bytes of the ongoing read not found in the active
+* headers yet.
+*
+* \param start
+* The index of the byte in the read to start the search from. Updated to
+* the index of the first byte of the run.
+*
+* \param end
+* The index after the last byte to search.
+*
+* \return
+* The length of the run or zero if all bytes up to the end are found.
+*
+*******************************************************************************/
+static uint32_t GetUncoveredRun(
+    uint32_t* start,
+    uint32_t end)
+{
+    uint32_t index = *start;
+    uint32_t length = 0u;
+
+    while ((index < end) && (0u != (readCoverage[index / 32u] & (1uL << (index % 32u)))))
+    {
+        index++;
+    }
+    *start = index;
+    while (((index + length) < end) &&
+           (0u == (readCoverage[(index + length) / 32u] & (1uL << ((index + length) % 32u)))))
+    {
+        length++;
+    }
+    return (length);
+}
+
+
+/*******************************************************************************
+* Function Name: SetCovered
+****************************************************************************//**
+*
+* Marks the bytes of the ongoing read as found in an active header.
+*
+* \param start
+* The index of the first byte in the read.
+*
+* \param length
+* The number of bytes.
+*
+*******************************************************************************/
+static void SetCovered(
+    uint32_t start,
+    uint32_t length)
+{
+    uint32_t index;
+
+    for (index = start; index < (start + length); index++)
+    {
+        readCoverage[index / 32u] |= (1uL << (index % 32u));
+    }
+}
+
+
+#endif /* (CY_EM_EEPROM_READ_BITMAP_SIZE > 0u) */
+
+/*******************************************************************************
+* Function Name: ReadOldestFirst
+****************************************************************************//**
+*
+* Reads data from a specified location when Simple Mode is disabled. Reads
+* the historic data of the range and applies all active headers over it,
+* the oldest first.
+*
+* \param addr
+* The logical start address in the Em_EEPROM storage to start reading data from.
+*
+* \param eepromData
+* The pointer to a user array to write data to.
+*
+* \param size
+* The amount of data to read in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* This function returns cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t ReadOldestFirst(
+    uint32_t addr,
+    void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
+    uint32_t byteInRow = CY_EM_EEPROM_BYTE_IN_ROW(context);
+    uint32_t numRows = CY_EM_EEPROM_NUM_ROWS(context);
+    uint32_t byteInRowShift = CY_EM_EEPROM_BYTE_IN_ROW_SHIFT(context);
+    uint32_t numRowsShift = CY_EM_EEPROM_NUM_ROWS_SHIFT(context);
     cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
     cy_en_em_eeprom_status_t retHistoricCrc;
     uint32_t i;
-    uint32_t k;
     uint32_t numRowReads;
-    uint32_t seqNum;
+    uint64_t seqNum;
     uint32_t sizeToCopy;
     uint32_t sizeRemaining;
-    uint32_t userBufferAddr;
     uint8_t* userBufferAddr_p;
-    uint32_t* ptrRow;
-    uint32_t* ptrRowWork;
+    uint32_t rowAddr;
+    const uint32_t* ptrRowWork;
     uint32_t curRowOffset;
-    uint32_t strHistAddr;
-    uint32_t endHistAddr;
+    uint32_t lastSlot;
     uint32_t currentAddr;
     uint32_t strHeadAddr;
     uint32_t endHeadAddr;
     uint32_t dstOffset;
     uint32_t srcOffset;
     cy_en_em_eeprom_status_t crcStatus;
-    uint32_t numReads = context->numberOfRows;
+    uint32_t numReads = numRows;
 
     /* 1. Clears the user buffer */
     (void)memset(eepromData, 0, size);
@@ -324,52 +841,39 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
     currentAddr = addr;
     sizeRemaining = size;
     userBufferAddr_p = eepromData;
-    userBufferAddr = (uint32_t)userBufferAddr_p;
-    numRowReads = ((((addr + size) - 1u) / context->byteInRow) - (addr / context->byteInRow)) + 1u;
-
-    ptrRow =
-        (uint32_t*)(context->userNvmStartAddr +
-                    ((context->rowSize) * (addr / context->byteInRow)));
+    numRowReads = (DivideFast((addr + size) - 1u, byteInRow, byteInRowShift) -
+                   DivideFast(addr, byteInRow, byteInRowShift)) + 1u;
+    lastSlot = GetHistoricSlot(context->lastWrittenRowAddr, seqNum, context);
 
     for (i = 0u; i < numRowReads; i++)
     {
-        if (1u < context->wearLevelingFactor)
-        {
-            /* Jumps to the active sector if wear leveling is enabled */
-            ptrRow = GetReadRowPointer(context->ptrLastWrittenRow, context);
-            /* Finds a row in the active sector with a relevant historic data address */
-            for (k = 0u; k < context->numberOfRows; k++)
-            {
-                ptrRow = GetNextRowPointer(ptrRow, context);
-                strHistAddr = ((((uint32_t)ptrRow - context->userNvmStartAddr) /
-                                (context->rowSize)) % context->numberOfRows) *
-                              ((context->rowSize) / 2u);
-                endHistAddr = strHistAddr + ((context->rowSize) / 2u);
-                if ((currentAddr >= strHistAddr) && (currentAddr < endHistAddr))
-                {
-                    /* The row with needed address is found */
-                    break;
-                }
-            }
-        }
-
-        curRowOffset = context->byteInRow + (currentAddr % context->byteInRow);
-        sizeToCopy = context->byteInRow - (currentAddr % context->byteInRow);
+        /* Each of the last numberOfRows written rows holds the historic data of a different
+         * slot, so the row with the needed address is found by its distance from the last row.
+         */
+        rowAddr = GetPrevRowAddr(context->lastWrittenRowAddr,
+                                 RemainderFast((lastSlot + numRows) -
+                                               DivideFast(currentAddr, byteInRow, byteInRowShift),
+                                               numRows, numRowsShift),
+                                 context);
+
+        /* The historic data takes the second half of the row */
+        curRowOffset = byteInRow + RemainderFast(currentAddr, byteInRow, byteInRowShift);
+        sizeToCopy = rowSize - curRowOffset;
         if (i >= (numRowReads - 1u))
         {
             sizeToCopy = sizeRemaining;
         }
 
         retHistoricCrc = CY_EM_EEPROM_SUCCESS;
-        if (CY_EM_EEPROM_SUCCESS != CheckRowChecksum(ptrRow, context->rowSize))
+        ptrRowWork = ReadRow(rowAddr, context);
+        if (CY_EM_EEPROM_SUCCESS != CheckRowChecksum(ptrRowWork, rowSize))
         {
             /* CRC is bad. Checks if the redundant copy if enabled */
             retHistoricCrc = CY_EM_EEPROM_BAD_CHECKSUM;
             if (0u != context->redundantCopy)
             {
-                ptrRow += ((context->numberOfRows * context->wearLevelingFactor) *
-                           (context->rowSize /4));
-                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, (context->rowSize)))
+                ptrRowWork = ReadRedundantRow(rowAddr, context);
+                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowWork, rowSize))
                 {
                     retHistoricCrc = CY_EM_EEPROM_REDUNDANT_COPY_USED;
                 }
@@ -378,13 +882,12 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
         /* If the correct CRC is found, then copies the data to the user's buffer */
         if (CY_EM_EEPROM_BAD_CHECKSUM != retHistoricCrc)
         {
-            context->bd->read(context->bd->context, ((uint32_t)ptrRow + curRowOffset), sizeToCopy,
-                              (uint8_t*)userBufferAddr);
+            (void)memcpy(userBufferAddr_p, &((const uint8_t*)ptrRowWork)[curRowOffset], sizeToCopy);
         }
         else
         {
-            (void)memset((uint8_t*)userBufferAddr, 0, sizeToCopy);
-            if ((0u == GetStoredSeqNum(ptrRow)) && (0u == GetStoredRowChecksum(ptrRow)))
+            (void)memset(userBufferAddr_p, 0, sizeToCopy);
+            if (IsRowErased(ptrRowWork))
             {
                 /*
                  * Considers a row with a bad checksum as the row never that has never been
@@ -396,15 +899,9 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
             }
         }
 
-
-        if (1u >= context->wearLevelingFactor)
-        {
-            ptrRow = GetNextRowPointer(ptrRow, context);
-        }
-
         sizeRemaining -= sizeToCopy;
         currentAddr += sizeToCopy;
-        userBufferAddr += sizeToCopy;
+        userBufferAddr_p = &userBufferAddr_p[sizeToCopy];
 
         /* Reports the status of the CRC verification in the following order:
          * The highest priority: CY_EM_EEPROM_BAD_CHECKSUM
@@ -422,19 +919,18 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
     }
 
     /* 4. Reads data from all active headers */
-    ptrRow = GetReadRowPointer(context->ptrLastWrittenRow, context);
+    rowAddr = GetReadRowAddr(context->lastWrittenRowAddr, context);
     for (i = 0u; i < numReads; i++)
     {
-        ptrRow = GetNextRowPointer(ptrRow, context);
-        ptrRowWork = ptrRow;
+        rowAddr = GetNextRowAddr(rowAddr, context);
+        ptrRowWork = ReadRow(rowAddr, context);
         /* Checks CRC of the row to be read except the last row of a recently created header */
-        crcStatus = CheckRowChecksum(ptrRowWork, context->rowSize);
+        crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
         if ((CY_EM_EEPROM_SUCCESS != crcStatus) && (0u != context->redundantCopy))
         {
-            /* Calculates the redundant copy pointer */
-            ptrRowWork += ((context->numberOfRows * context->wearLevelingFactor) *
-                           context->rowSize / 4);
-            crcStatus = CheckRowChecksum(ptrRowWork, context->rowSize);
+            /* Reads the redundant copy */
+            ptrRowWork = ReadRedundantRow(rowAddr, context);
+            crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
         }
 
         /* Skips the row if CRC is bad */
@@ -442,7 +938,8 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
         {
             /* The address of header data */
             strHeadAddr = ptrRowWork[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32];
-            endHeadAddr = strHeadAddr + ptrRowWork[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32];
+            endHeadAddr = strHeadAddr + (ptrRowWork[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] &
+                                         CY_EM_EEPROM_HEADER_LEN_MASK);
 
             /* Skips the row if the header data address is out of the user's requested address range
              */
@@ -456,12 +953,9 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
                     ((endHeadAddr < (addr + size)) ? endHeadAddr : (addr + size)) - sizeToCopy;
 
                 userBufferAddr_p = eepromData;
-                /* Reads from the memory and writes to the buffer */
-                context->bd->read(context->bd->context,
-                                  ((uint32_t)ptrRowWork + srcOffset +
-                                   CY_EM_EEPROM_HEADER_DATA_OFFSET),
-                                  sizeToCopy,
-                                  (uint8_t*)((uint32_t)userBufferAddr_p + dstOffset));
+                /* Copies from the row read and writes to the buffer */
+                GetHeaderData(ptrRowWork, srcOffset, &userBufferAddr_p[dstOffset], sizeToCopy,
+                              context);
             }
         }
     }
@@ -471,107 +965,408 @@ static cy_en_em_eeprom_status_t ReadExtendedMode(
 
 
 //--------------------------------------------------------------------------------------------------
-// Cy_Em_EEPROM_Write
+// Cy_Em_EEPROM_ReadPtr
 //--------------------------------------------------------------------------------------------------
-cy_en_em_eeprom_status_t Cy_Em_EEPROM_Write(
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_ReadPtr(
     uint32_t addr,
-    const void* eepromData,
     uint32_t size,
+    void* buffer,
+    const void** ptr,
     cy_stc_eeprom_context_t* context)
 {
     cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    const uint8_t* ptrData;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
 
-    /* Checks if the Em_EEPROM data does not exceed the Em_EEPROM capacity */
-    if ((0u != size) && ((addr + size) <= (context->eepromSize)) && (NULL != eepromData))
+    /* Validates the input parameters */
+    if ((0u != size) && ((addr + size) <= (context->eepromSize)) && (NULL != ptr))
     {
+        StartOperation(context);
         if (0u != context->simpleMode)
         {
-            result = WriteSimpleMode(addr, eepromData, size, context);
+            result = CY_EM_EEPROM_SUCCESS;
+            ptrData = GetSimpleModePtr(addr, size, (const cy_stc_eeprom_context_t*)context);
         }
         else
         {
-            result = WriteExtendedMode(addr, eepromData, size, context);
+            ptrData = GetExtendedModePtr(addr, size, &result, context);
+        }
+
+        if (NULL != ptrData)
+        {
+            CY_EM_EEPROM_STATS_ADD(numReads, 1u);
+            CY_EM_EEPROM_STATS_ADD_TIME(timeRead, startTime);
+            *ptr = ptrData;
+        }
+        else if (NULL != buffer)
+        {
+            /* The range cannot be served from a single place in the storage */
+            result = Cy_Em_EEPROM_Read(addr, buffer, size, context);
+            *ptr = buffer;
+        }
+        else
+        {
+            result = CY_EM_EEPROM_BAD_PARAM;
         }
     }
+
     return result;
 }
 
 
 /*******************************************************************************
-* Function Name: WriteSimpleMode
+* Function Name: GetSimpleModePtr
 ****************************************************************************//**
 *
-* Writes data to a specified location in Simple Mode only.
+* Returns the pointer to the data of a specified range in Simple mode.
 *
 * \param addr
-* The logical start address in the Em_EEPROM storage to start writing data to.
-*
-* \param eepromData
-* Data to write to Em_EEPROM.
+* The logical start address in the Em_EEPROM storage.
 *
 * \param size
-* The amount of data to write to Em_EEPROM in bytes.
+* The size of the range in bytes.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* This function returns cy_en_em_eeprom_status_t.
+* The pointer to the data or NULL if the range must be copied by
+* Cy_Em_EEPROM_Read().
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t WriteSimpleMode(
+static const uint8_t* GetSimpleModePtr(
     uint32_t addr,
-    const void* eepromData,
     uint32_t size,
-    cy_stc_eeprom_context_t* context)
+    const cy_stc_eeprom_context_t* context)
 {
-    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
-    uint32_t wrCnt = 0u;
-    uint32_t numBytes = 0;
-    uint32_t startAddr = addr % (context->rowSize);
-    uint32_t numWrites = (((size + startAddr) - 1u) / (context->rowSize)) + 1u;
-    uint32_t* ptrRow = (uint32_t*)(context->userNvmStartAddr + (addr - startAddr));
-    const uint8_t* ptrUserData_p = eepromData;
-    uint32_t ptrUserData = (uint32_t)ptrUserData_p;
+    const uint8_t* ptrData = NULL;
 
-    uint32_t lc_size = size;
+    #if (CY_EM_EEPROM_NVM_MEMORY_MAPPED == 1u)
+    (void)size;
+    #if (CPUSS_FLASHC_ECT == 1)
+    /* Reading erased Work Flash causes an ECC fault, so the copy reports zeros instead */
+    if (!WorkFlashIsErased(context->userNvmStartAddr + addr, size))
+    #endif /* (CPUSS_FLASHC_ECT == 1) */
+    {
+        ptrData = (const uint8_t*)(uintptr_t)(context->userNvmStartAddr + addr);
+    }
+    #else /* (CY_EM_EEPROM_NVM_MEMORY_MAPPED == 1u) */
+    const uint32_t* ptrRow;
+    uint32_t rowOffset = addr % context->rowSize;
 
-    while (wrCnt < numWrites)
+    /* Only a range within one row can be served from the row cache */
+    if ((rowOffset + size) <= context->rowSize)
     {
-        #if (CPUSS_FLASHC_ECT == 1)
-        /* Fills the RAM buffer with all 0s if the row has never been written before */
-        if (WorkFlashIsErased(ptrRow, (context->rowSize)))
-        {
-            (void)memset((uint8_t*)&writeRamBuffer[0u], 0, (context->rowSize));
-        }
-        else
-        #endif /* (CPUSS_FLASHC_ECT == 1) */
+        ptrRow = ReadRow(context->userNvmStartAddr + (addr - rowOffset), context);
+        if (NULL != ptrRow)
         {
-            /* Fills the RAM buffer with nvm data for the case when not a whole row is requested to
-               be
-               overwritten */
-            context->bd->read(context->bd->context,
-                              (uint32_t)ptrRow,
-                              (context->rowSize),
-                              (uint8_t*)&writeRamBuffer[0u]);
+            ptrData = &((const uint8_t*)ptrRow)[rowOffset];
         }
+    }
+    #endif /* (CY_EM_EEPROM_NVM_MEMORY_MAPPED == 1u) */
 
-        /* Calculates the number of bytes to be written into the current row */
-        numBytes = (context->rowSize) - startAddr;
-        if (numBytes > lc_size)
-        {
-            numBytes = lc_size;
-        }
-        /* Overwrites the RAM buffer with new data */
-        (void)memcpy((uint8_t*)((uint32_t)&writeRamBuffer[0u] + startAddr),
-                     (const uint8_t*)ptrUserData, numBytes);
+    return ptrData;
+}
 
-        /* Writes data to the specified nvm row */
-        result = WriteRow(ptrRow, &writeRamBuffer[0u], context);
 
-        if (CY_EM_EEPROM_SUCCESS == result)
-        {
-            context->ptrLastWrittenRow = ptrRow;
+/*******************************************************************************
+* Function Name: GetExtendedModePtr
+****************************************************************************//**
+*
+* Returns the pointer to the data of a specified range when Simple Mode is
+* disabled. The pointer is available only if the range is in the historic data
+* of one row and no active header overrides it.
+*
+* \param addr
+* The logical start address in the Em_EEPROM storage.
+*
+* \param size
+* The size of the range in bytes.
+*
+* \param ptrResult
+* The pointer to store the status of the read operation to.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The pointer to the data or NULL if the range must be copied by
+* Cy_Em_EEPROM_Read().
+*
+*******************************************************************************/
+static const uint8_t* GetExtendedModePtr(
+    uint32_t addr,
+    uint32_t size,
+    cy_en_em_eeprom_status_t* ptrResult,
+    cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
+    uint32_t byteInRow = CY_EM_EEPROM_BYTE_IN_ROW(context);
+    uint32_t numRows = CY_EM_EEPROM_NUM_ROWS(context);
+    uint32_t byteInRowShift = CY_EM_EEPROM_BYTE_IN_ROW_SHIFT(context);
+    uint32_t dataRow = DivideFast(addr, byteInRow, byteInRowShift);
+    uint32_t dataOffset = byteInRow + (addr - (dataRow * byteInRow));
+    const uint8_t* ptrData = NULL;
+    const uint32_t* ptrRowWork;
+    cy_en_em_eeprom_status_t crcStatus;
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    uint64_t seqNum;
+    uint32_t rowAddr;
+    uint32_t strHeadAddr;
+    uint32_t endHeadAddr;
+    uint32_t i;
+    bool isOverridden = false;
+
+    if (dataRow == DivideFast((addr + size) - 1u, byteInRow, byteInRowShift))
+    {
+        (void)CheckLastWrittenRowIntegrity(&seqNum, context);
+
+        /* Checks that no active header holds data of the range */
+        rowAddr = GetReadRowAddr(context->lastWrittenRowAddr, context);
+        for (i = 0u; (i < numRows) && (!isOverridden); i++)
+        {
+            rowAddr = GetNextRowAddr(rowAddr, context);
+            ptrRowWork = ReadRow(rowAddr, context);
+            crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+            if ((CY_EM_EEPROM_SUCCESS != crcStatus) && (0u != context->redundantCopy))
+            {
+                ptrRowWork = ReadRedundantRow(rowAddr, context);
+                crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+            }
+            if (CY_EM_EEPROM_SUCCESS == crcStatus)
+            {
+                strHeadAddr = ptrRowWork[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32];
+                endHeadAddr = strHeadAddr + (ptrRowWork[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] &
+                                             CY_EM_EEPROM_HEADER_LEN_MASK);
+                isOverridden = ((strHeadAddr < (addr + size)) && (endHeadAddr > addr));
+            }
+        }
+
+        if (!isOverridden)
+        {
+            /* Reads the historic row last so that the row cache still holds it on return */
+            rowAddr = GetPrevRowAddr(context->lastWrittenRowAddr,
+                                     RemainderFast((GetHistoricSlot(context->lastWrittenRowAddr,
+                                                                    seqNum, context) + numRows) -
+                                                   dataRow, numRows,
+                                                   CY_EM_EEPROM_NUM_ROWS_SHIFT(context)),
+                                     context);
+            ptrRowWork = ReadRow(rowAddr, context);
+            crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+            if ((CY_EM_EEPROM_SUCCESS != crcStatus) && (0u != context->redundantCopy))
+            {
+                ptrRowWork = ReadRedundantRow(rowAddr, context);
+                crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+                rowAddr = GetRedundantRowAddr(rowAddr, context);
+                result = CY_EM_EEPROM_REDUNDANT_COPY_USED;
+            }
+            if (CY_EM_EEPROM_SUCCESS == crcStatus)
+            {
+                #if (CY_EM_EEPROM_NVM_MEMORY_MAPPED == 1u)
+                ptrData = (const uint8_t*)(uintptr_t)(rowAddr + dataOffset);
+                #else
+                ptrData = &((const uint8_t*)ptrRowWork)[dataOffset];
+                #endif /* (CY_EM_EEPROM_NVM_MEMORY_MAPPED == 1u) */
+                *ptrResult = result;
+            }
+        }
+    }
+
+    return ptrData;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_Write
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_Write(
+    uint32_t addr,
+    const void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    /* Checks if the Em_EEPROM data does not exceed the Em_EEPROM capacity */
+    if ((0u != size) && ((addr + size) <= (context->eepromSize)) && (NULL != eepromData))
+    {
+        StartOperation(context);
+        CY_EM_EEPROM_STATS_ADD(numWrites, 1u);
+        if (0u != context->simpleMode)
+        {
+            result = WriteSimpleMode(addr, eepromData, size, context);
+        }
+        else
+        {
+            result = WriteExtendedMode(addr, eepromData, size, context);
+        }
+        CY_EM_EEPROM_STATS_ADD_TIME(timeWrite, startTime);
+    }
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_WriteDelta
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_WriteDelta(
+    uint32_t addr,
+    const void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    /* Checks if the Em_EEPROM data does not exceed the Em_EEPROM capacity */
+    if ((0u != size) && ((addr + size) <= (context->eepromSize)) && (NULL != eepromData))
+    {
+        StartOperation(context);
+        CY_EM_EEPROM_STATS_ADD(numWrites, 1u);
+        if (0u != context->simpleMode)
+        {
+            result = WriteDeltaSimpleMode(addr, eepromData, size, context);
+        }
+        else
+        {
+            result = WriteDeltaExtendedMode(addr, eepromData, size, context);
+        }
+        CY_EM_EEPROM_STATS_ADD_TIME(timeWrite, startTime);
+    }
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_WriteImage
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_WriteImage(
+    const void* eepromData,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    if ((NULL != eepromData) && (NULL != context))
+    {
+        StartOperation(context);
+        CY_EM_EEPROM_STATS_ADD(numWrites, 1u);
+        if (0u != context->simpleMode)
+        {
+            result = WriteSimpleMode(0u, eepromData, context->eepromSize, context);
+        }
+        else
+        {
+            result = WriteImageExtendedMode(eepromData, context);
+        }
+        CY_EM_EEPROM_STATS_ADD_TIME(timeWrite, startTime);
+    }
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: WriteSimpleMode
+****************************************************************************//**
+*
+* Writes data to a specified location in Simple Mode only.
+*
+* \param addr
+* The logical start address in the Em_EEPROM storage to start writing data to.
+*
+* \param eepromData
+* Data to write to Em_EEPROM.
+*
+* \param size
+* The amount of data to write to Em_EEPROM in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* This function returns cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t WriteSimpleMode(
+    uint32_t addr,
+    const void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    uint32_t wrCnt = 0u;
+    uint32_t numBytes = 0;
+    bool isRowRead;
+    uint32_t startAddr = addr % (context->rowSize);
+    uint32_t numWrites = (((size + startAddr) - 1u) / (context->rowSize)) + 1u;
+    uint32_t rowAddr = context->userNvmStartAddr + (addr - startAddr);
+    const uint8_t* ptrUserData = eepromData;
+
+    uint32_t lc_size = size;
+
+    while (wrCnt < numWrites)
+    {
+        /* Calculates the number of bytes to be written into the current row */
+        numBytes = (context->rowSize) - startAddr;
+        if (numBytes > lc_size)
+        {
+            numBytes = lc_size;
+        }
+
+        if (numBytes == context->rowSize)
+        {
+            /* A whole row is overwritten, so it is programmed without reading it first */
+            if (0u == ((uintptr_t)ptrUserData % CY_EM_EEPROM_U32))
+            {
+                result = WriteRow(rowAddr, (const uint32_t*)(const void*)ptrUserData, context);
+            }
+            else
+            {
+                /* The user's data is not word-aligned */
+                (void)memcpy(&writeRamBuffer[0u], ptrUserData, numBytes);
+                result = WriteRow(rowAddr, &writeRamBuffer[0u], context);
+            }
+        }
+        else
+        {
+            #if (CPUSS_FLASHC_ECT == 1)
+            /* Fills the RAM buffer with all 0s if the row has never been written before */
+            if (WorkFlashRowIsErased(rowAddr, context))
+            {
+                (void)memset((uint8_t*)&writeRamBuffer[0u], 0, (context->rowSize));
+                isRowRead = false;
+            }
+            else
+            #endif /* (CPUSS_FLASHC_ECT == 1) */
+            {
+                /* Fills the RAM buffer with nvm data as not a whole row is overwritten */
+                isRowRead = (CY_RSLT_SUCCESS ==
+                             BdRead(rowAddr, (context->rowSize), (uint8_t*)&writeRamBuffer[0u],
+                                    context));
+            }
+
+            /* Skips the row if it already holds the new data. In Simple mode a row is one
+             * program unit of the block device, so only the changed units are programmed.
+             */
+            if (isRowRead &&
+                (0 == memcmp(&((uint8_t*)&writeRamBuffer[0u])[startAddr], ptrUserData, numBytes)))
+            {
+                result = CY_EM_EEPROM_SUCCESS;
+            }
+            else
+            {
+                /* Overwrites the RAM buffer with new data */
+                (void)memcpy(&((uint8_t*)&writeRamBuffer[0u])[startAddr], ptrUserData, numBytes);
+
+                /* Writes data to the specified nvm row */
+                result = WriteRow(rowAddr, &writeRamBuffer[0u], context);
+            }
+        }
+
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            context->lastWrittenRowAddr = rowAddr;
         }
         else
         {
@@ -580,8 +1375,8 @@ static cy_en_em_eeprom_status_t WriteSimpleMode(
         /* Update pointers for the next row to be written if any */
         startAddr = 0u;
         lc_size -= numBytes;
-        ptrUserData += numBytes;
-        ptrRow += context->rowSize / 4;
+        ptrUserData = &ptrUserData[numBytes];
+        rowAddr += context->rowSize;
         wrCnt++;
     }
 
@@ -589,6 +1384,81 @@ static cy_en_em_eeprom_status_t WriteSimpleMode(
 }
 
 
+/*******************************************************************************
+* Function Name: WriteDeltaSimpleMode
+****************************************************************************//**
+*
+* Writes data to a specified location in Simple Mode only, skipping the rows
+* that already hold the new data. Unlike WriteSimpleMode(), the whole rows are
+* read and compared too before they are programmed.
+*
+* \param addr
+* The logical start address in the Em_EEPROM storage to start writing data to.
+*
+* \param eepromData
+* Data to write to Em_EEPROM.
+*
+* \param size
+* The amount of data to write to Em_EEPROM in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* This function returns cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t WriteDeltaSimpleMode(
+    uint32_t addr,
+    const void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    uint32_t pos = 0u;
+    uint32_t partSize;
+    uint32_t rowAddr;
+    bool isRowEqual;
+    const uint8_t* ptrUserData = eepromData;
+
+    while ((pos < size) && (CY_EM_EEPROM_SUCCESS == result))
+    {
+        /* Calculates the part of the data that falls into the current row */
+        partSize = (context->rowSize) - ((addr + pos) % (context->rowSize));
+        if (partSize > (size - pos))
+        {
+            partSize = size - pos;
+        }
+
+        isRowEqual = false;
+        if (partSize == context->rowSize)
+        {
+            rowAddr = context->userNvmStartAddr + (addr + pos);
+            #if (CPUSS_FLASHC_ECT == 1)
+            /* A row that has never been written before cannot be read */
+            if (!WorkFlashRowIsErased(rowAddr, context))
+            #endif /* (CPUSS_FLASHC_ECT == 1) */
+            {
+                isRowEqual = ((CY_RSLT_SUCCESS ==
+                               BdRead(rowAddr, (context->rowSize),
+                                      (uint8_t*)&writeRamBuffer[0u], context)) &&
+                              (0 == memcmp(&writeRamBuffer[0u], &ptrUserData[pos],
+                                           (context->rowSize))));
+            }
+        }
+
+        /* The partial rows are compared by WriteSimpleMode() */
+        if (!isRowEqual)
+        {
+            result = WriteSimpleMode(addr + pos, &ptrUserData[pos], partSize, context);
+        }
+        pos += partSize;
+    }
+
+    return result;
+}
+
+
 /*******************************************************************************
 * Function Name: WriteExtendedMode
 ****************************************************************************//**
@@ -617,70 +1487,90 @@ static cy_en_em_eeprom_status_t WriteExtendedMode(
     uint32_t size,
     cy_stc_eeprom_context_t* context)
 {
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
     cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
     cy_en_em_eeprom_status_t retWriteRow = CY_EM_EEPROM_SUCCESS;
-    uint32_t wrCnt;
-    uint32_t seqNum;
-    uint32_t* ptrRow;
-    uint32_t* ptrRowCopy;
-
-    const uint8_t* userBufferAddr_p = eepromData;
-    uint32_t ptrUserData = (uint32_t)userBufferAddr_p;
-    uint32_t numWrites = ((size - 1u) / context->headerDataLength) + 1u;
+    uint64_t seqNum;
+    uint32_t rowAddr;
+    uint32_t rowAddrCopy;
+    uint32_t startTime;
+    uint32_t chunkSize;
+    #if (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u)
+    uint32_t packedSize;
+    #endif /* (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u) */
+
+    const uint8_t* ptrUserData = eepromData;
     uint32_t lc_addr = addr;
     uint32_t lc_size = size;
 
     /* Checks CRC of the last written row and find the last written row if the CRC is broken */
     (void)CheckLastWrittenRowIntegrity(&seqNum, context);
-    ptrRow = context->ptrLastWrittenRow;
+    rowAddr = context->lastWrittenRowAddr;
 
-    for (wrCnt = 0u; wrCnt < numWrites; wrCnt++)
+    while (0u != lc_size)
     {
-        ptrRow = GetNextRowPointer(ptrRow, context);
+        rowAddr = GetNextRowAddr(rowAddr, context);
         seqNum++;
 
         /* 1. Clears the RAM buffer */
-        (void)memset(&writeRamBuffer[0u], 0, (context->rowSize));
+        (void)memset(&writeRamBuffer[0u], 0, rowSize);
 
         /* 2. Fills the EM_EEPROM service header info */
-        writeRamBuffer[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32] = seqNum;
+        SetSeqNum(&writeRamBuffer[0u], seqNum);
         writeRamBuffer[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32] = lc_addr;
-        writeRamBuffer[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] = context->headerDataLength;
-        if (wrCnt == (numWrites - 1u))
-        {
-            /* Fills in the remaining size if this is the last row to write */
-            writeRamBuffer[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] = lc_size;
-        }
+        chunkSize = (lc_size < context->headerDataLength) ? lc_size : context->headerDataLength;
+        writeRamBuffer[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] = chunkSize;
 
         /* 3. Writes the user's data to the buffer */
-        (void)memcpy((uint8_t*)&writeRamBuffer[CY_EM_EEPROM_HEADER_DATA_OFFSET_U32],
-                     (const uint8_t*)ptrUserData,
-                     writeRamBuffer[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32]);
+        #if (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u)
+        if (lc_size > context->headerDataLength)
+        {
+            /* Uses the compressed data if it holds more than the plain header data */
+            packedSize = CompressHeaderData(ptrUserData, lc_size,
+                                            (uint8_t*)&writeRamBuffer[
+                                                CY_EM_EEPROM_HEADER_DATA_OFFSET_U32],
+                                            context->headerDataLength);
+            if (packedSize > chunkSize)
+            {
+                chunkSize = packedSize;
+                writeRamBuffer[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] =
+                    chunkSize | CY_EM_EEPROM_HEADER_LEN_COMPRESSED;
+            }
+        }
+        if (0u == (writeRamBuffer[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] &
+                   CY_EM_EEPROM_HEADER_LEN_COMPRESSED))
+        #endif /* (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u) */
+        {
+            (void)memcpy((uint8_t*)&writeRamBuffer[CY_EM_EEPROM_HEADER_DATA_OFFSET_U32],
+                         ptrUserData, chunkSize);
+        }
 
         /* 4. Writes the historic data to the buffer */
-        result = CopyHistoricData(&writeRamBuffer[0u], ptrRow, context);
+        startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+        result = CopyHistoricData(&writeRamBuffer[0u], rowAddr, context);
+        CY_EM_EEPROM_STATS_ADD_TIME(timeHistoricData, startTime);
 
         /* 5. Writes the data from other headers */
-        result = CopyHeadersData(&writeRamBuffer[0u], ptrRow, context);
+        startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+        result = CopyHeadersData(&writeRamBuffer[0u], rowAddr, context);
+        CY_EM_EEPROM_STATS_ADD_TIME(timeHeadersData, startTime);
 
         /* 6. Calculates a checksum */
-        writeRamBuffer[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] = CalculateRowChecksum(
-            &writeRamBuffer[0u], (context->rowSize));
+        writeRamBuffer[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] |= CalculateRowChecksum(
+            &writeRamBuffer[0u], rowSize);
 
         /* 7. Writes data to the specified nvm row */
-        retWriteRow = WriteRow(ptrRow, &writeRamBuffer[0u], context);
+        retWriteRow = WriteRow(rowAddr, &writeRamBuffer[0u], context);
         if ((CY_EM_EEPROM_SUCCESS == retWriteRow) && (0u != context->redundantCopy))
         {
             /* Writes data to the specified nvm row in the redundant copy area */
-            ptrRowCopy = ptrRow +
-                         ((context->numberOfRows * context->wearLevelingFactor) *
-                          (context->rowSize / 4));
-            retWriteRow = WriteRow(ptrRowCopy, &writeRamBuffer[0u], context);
+            rowAddrCopy = GetRedundantRowAddr(rowAddr, context);
+            retWriteRow = WriteRow(rowAddrCopy, &writeRamBuffer[0u], context);
         }
 
         if (CY_EM_EEPROM_SUCCESS == retWriteRow)
         {
-            context->ptrLastWrittenRow = ptrRow;
+            context->lastWrittenRowAddr = rowAddr;
         }
         else
         {
@@ -688,9 +1578,9 @@ static cy_en_em_eeprom_status_t WriteExtendedMode(
         }
 
         /* Switches to the next row */
-        lc_size -= context->headerDataLength;
-        lc_addr += context->headerDataLength;
-        ptrUserData += context->headerDataLength;
+        lc_size -= chunkSize;
+        lc_addr += chunkSize;
+        ptrUserData = &ptrUserData[chunkSize];
     }
 
     if (CY_EM_EEPROM_SUCCESS != retWriteRow)
@@ -702,33 +1592,190 @@ static cy_en_em_eeprom_status_t WriteExtendedMode(
 }
 
 
-//--------------------------------------------------------------------------------------------------
-// Cy_Em_EEPROM_Erase
-//--------------------------------------------------------------------------------------------------
-cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context)
-{
-    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
-    cy_en_em_eeprom_status_t retStatus;
-    uint32_t i;
-    uint32_t* ptrRow;
-    uint32_t* ptrRowCopy;
-    uint32_t seqNum;
-    uint32_t numRows = context->numberOfRows * context->wearLevelingFactor;
-
-    //Clear buffer
-    (void)memset(&writeRamBuffer[0u], 0x0, (context->rowSize));
-
-    if (0u != context->simpleMode)
+/*******************************************************************************
+* Function Name: WriteDeltaExtendedMode
+****************************************************************************//**
+*
+* Writes the changed parts of the data to a specified location when Simple
+* Mode is disabled. The stored data is read up to a row size at a time into
+* the RAM buffer. From the first changed byte, the changed bytes within
+* headerDataLength bytes are written by one header, which is the least number
+* of rows for the changes.
+*
+* \param addr
+* The logical start address in the Em_EEPROM storage to start writing data to.
+*
+* \param eepromData
+* The pointer to the user's data to write.
+*
+* \param size
+* The amount of data to write in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* This function returns cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t WriteDeltaExtendedMode(
+    uint32_t addr,
+    const void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    cy_en_em_eeprom_status_t retRead;
+    const uint8_t* ptrUserData = eepromData;
+    const uint8_t* ptrStoredData = (const uint8_t*)&writeRamBuffer[0u];
+    uint32_t pos = 0u;
+    uint32_t readSize;
+    uint32_t strChange;
+    uint32_t endChange;
+
+    while ((pos < size) && (CY_EM_EEPROM_WRITE_FAIL != result))
+    {
+        readSize = ((size - pos) < context->rowSize) ? (size - pos) : context->rowSize;
+        retRead = ReadExtendedMode(addr + pos, (void*)&writeRamBuffer[0u], readSize, context);
+
+        /* Finds the first changed byte. The data of a row with a bad checksum is written. */
+        strChange = 0u;
+        while ((CY_EM_EEPROM_BAD_CHECKSUM != retRead) && (strChange < readSize) &&
+               (ptrStoredData[strChange] == ptrUserData[pos + strChange]))
+        {
+            strChange++;
+        }
+
+        if (strChange >= readSize)
+        {
+            /* No changes in the data read */
+            pos += readSize;
+        }
+        else if (((strChange + context->headerDataLength) > readSize) &&
+                 ((pos + readSize) < size))
+        {
+            /* Reads again from the first changed byte to compare a whole header length */
+            pos += strChange;
+        }
+        else
+        {
+            /* Finds the last changed byte that fits in one header with the first one */
+            endChange = strChange + context->headerDataLength;
+            endChange = (endChange < readSize) ? endChange : readSize;
+            while ((CY_EM_EEPROM_BAD_CHECKSUM != retRead) &&
+                   (ptrStoredData[endChange - 1u] == ptrUserData[(pos + endChange) - 1u]))
+            {
+                endChange--;
+            }
+
+            /* Overwrites the RAM buffer */
+            result = WriteExtendedMode(addr + pos + strChange, &ptrUserData[pos + strChange],
+                                       endChange - strChange, context);
+            pos += endChange;
+        }
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: WriteImageExtendedMode
+****************************************************************************//**
+*
+* Writes the whole Em_EEPROM content when Simple Mode is disabled. Each of
+* the next numberOfRows rows of the ring gets the content of its historic data
+* slot and an empty header, so the rows holding active headers from earlier
+* writes are out of the ring window when the function completes.
+*
+* \param eepromData
+* The pointer to the content of eepromSize bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* This function returns cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t WriteImageExtendedMode(
+    const uint8_t* eepromData,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    uint64_t seqNum;
+    uint32_t rowAddr;
+    uint32_t slotAddr;
+    uint32_t sizeToCopy;
+    uint32_t i;
+
+    (void)CheckLastWrittenRowIntegrity(&seqNum, context);
+    rowAddr = context->lastWrittenRowAddr;
+
+    for (i = 0u; (i < context->numberOfRows) && (CY_EM_EEPROM_SUCCESS == result); i++)
+    {
+        rowAddr = GetNextRowAddr(rowAddr, context);
+        seqNum++;
+
+        (void)memset(&writeRamBuffer[0u], 0, (context->rowSize));
+        SetSeqNum(&writeRamBuffer[0u], seqNum);
+
+        /* The historic data of the last slot may be shorter than byteInRow */
+        slotAddr = GetHistoricSlot(rowAddr, seqNum, context) * context->byteInRow;
+        sizeToCopy = context->eepromSize - slotAddr;
+        sizeToCopy = (sizeToCopy < context->byteInRow) ? sizeToCopy : context->byteInRow;
+        (void)memcpy(&((uint8_t*)&writeRamBuffer[0u])[context->byteInRow], &eepromData[slotAddr],
+                     sizeToCopy);
+
+        writeRamBuffer[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] |= CalculateRowChecksum(
+            &writeRamBuffer[0u], (context->rowSize));
+
+        result = WriteRow(rowAddr, &writeRamBuffer[0u], context);
+        if ((CY_EM_EEPROM_SUCCESS == result) && (0u != context->redundantCopy))
+        {
+            result = WriteRow(GetRedundantRowAddr(rowAddr, context), &writeRamBuffer[0u],
+                              context);
+        }
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            context->lastWrittenRowAddr = rowAddr;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_Erase
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    cy_en_em_eeprom_status_t retStatus;
+    uint32_t i;
+    uint32_t rowAddr;
+    uint32_t rowAddrCopy;
+    uint64_t seqNum;
+    uint32_t numRows = context->wearLevelingRows;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    //Clear buffer
+    (void)memset(&writeRamBuffer[0u], 0x0, (context->rowSize));
+    StartOperation(context);
+    CY_EM_EEPROM_STATS_ADD(numErases, 1u);
+
+    if (0u != context->simpleMode)
     {
-        ptrRow = (uint32_t*)context->userNvmStartAddr;
+        rowAddr = context->userNvmStartAddr;
         for (i = 0u; i < numRows; i++)
         {
-            retStatus = EraseRow(ptrRow, &writeRamBuffer[0u], context);
+            retStatus = EraseRow(rowAddr, &writeRamBuffer[0u], context);
             if (CY_EM_EEPROM_SUCCESS == result)
             {
                 result = retStatus;
             }
-            ptrRow += context->rowSize / 4;
+            rowAddr += context->rowSize;
         }
     }
     else
@@ -736,22 +1783,22 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context)
         /* Checks CRC if it is really the last row and the max sequence number */
         (void)CheckLastWrittenRowIntegrity(&seqNum, context);
 
-        /* Gets the last written row pointer */
-        ptrRow = context->ptrLastWrittenRow;
-        ptrRow = GetNextRowPointer(ptrRow, context);
+        /* Gets the last written row address */
+        rowAddr = context->lastWrittenRowAddr;
+        rowAddr = GetNextRowAddr(rowAddr, context);
 
         /* Prepares a zero buffer with a sequence number and checksum */
-        writeRamBuffer[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32] = seqNum + 1u;
-        writeRamBuffer[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] = CalculateRowChecksum(
+        SetSeqNum(&writeRamBuffer[0u], seqNum + 1u);
+        writeRamBuffer[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] |= CalculateRowChecksum(
             &writeRamBuffer[0u], (context->rowSize));
 
         /* Performs writing */
-        result = WriteRow(ptrRow, &writeRamBuffer[0u], context);
+        result = WriteRow(rowAddr, &writeRamBuffer[0u], context);
         /* Duplicates writing into a redundant copy if enabled */
         if (0u != context->redundantCopy)
         {
-            ptrRowCopy = ptrRow + (numRows * (context->rowSize / 4));
-            retStatus = WriteRow(ptrRowCopy, &writeRamBuffer[0u], context);
+            rowAddrCopy = GetRedundantRowAddr(rowAddr, context);
+            retStatus = WriteRow(rowAddrCopy, &writeRamBuffer[0u], context);
             if (CY_EM_EEPROM_SUCCESS == result)
             {
                 result = retStatus;
@@ -761,12 +1808,12 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context)
         /* If the write operation is unsuccessful, skip erasing Em_EEPROM */
         if (CY_EM_EEPROM_SUCCESS == result)
         {
-            context->ptrLastWrittenRow = ptrRow;
+            context->lastWrittenRowAddr = rowAddr;
             /* One row is already overwritten, so reduces the number of rows to be erased by one */
             for (i = 0u; i < (numRows - 1u); i++)
             {
-                ptrRow = GetNextRowPointer(ptrRow, context);
-                retStatus = EraseRow(ptrRow, &writeRamBuffer[0u], context);
+                rowAddr = GetNextRowAddr(rowAddr, context);
+                retStatus = EraseRow(rowAddr, &writeRamBuffer[0u], context);
                 if (CY_EM_EEPROM_SUCCESS == result)
                 {
                     result = retStatus;
@@ -774,8 +1821,8 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context)
                 /* Erases the redundant copy if enabled */
                 if (0u != context->redundantCopy)
                 {
-                    ptrRowCopy = ptrRow + (numRows * (context->rowSize / 4));
-                    retStatus = EraseRow(ptrRowCopy, &writeRamBuffer[0u], context);
+                    rowAddrCopy = GetRedundantRowAddr(rowAddr, context);
+                    retStatus = EraseRow(rowAddrCopy, &writeRamBuffer[0u], context);
                     if (CY_EM_EEPROM_SUCCESS == result)
                     {
                         result = retStatus;
@@ -785,449 +1832,3269 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context)
         }
     }
 
+    CY_EM_EEPROM_STATS_ADD_TIME(timeErase, startTime);
+
     return (result);
 }
 
 
 //--------------------------------------------------------------------------------------------------
-// Cy_Em_EEPROM_NumWrites
+// Cy_Em_EEPROM_Migrate
 //--------------------------------------------------------------------------------------------------
-uint32_t Cy_Em_EEPROM_NumWrites(cy_stc_eeprom_context_t* context)
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_Migrate(
+    const cy_stc_eeprom_config2_t* oldConfig,
+    const cy_stc_eeprom_config2_t* newConfig,
+    cy_stc_eeprom_context_t* context,
+    mtb_block_storage_t* block_device)
 {
-    uint32_t seqNum;
-
-    (void)CheckLastWrittenRowIntegrity(&seqNum, context);
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    cy_stc_eeprom_context_t oldContext;
+    uint32_t startOffset;
 
-    return (seqNum);
+    if ((NULL != oldConfig) && (NULL != newConfig) && (0u == oldConfig->simpleMode) &&
+        (0u == newConfig->simpleMode))
+    {
+        result = Cy_Em_EEPROM_Init_BD(oldConfig, &oldContext, block_device);
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            result = Cy_Em_EEPROM_Init_BD(newConfig, context, block_device);
+        }
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            /* The rows of the two layouts must not overlap partially */
+            startOffset = (oldContext.userNvmStartAddr > context->userNvmStartAddr) ?
+                          (oldContext.userNvmStartAddr - context->userNvmStartAddr) :
+                          (context->userNvmStartAddr - oldContext.userNvmStartAddr);
+            if ((GetLayoutId(&oldContext) == GetLayoutId(context)) ||
+                (0u != (startOffset % context->rowSize)))
+            {
+                result = CY_EM_EEPROM_BAD_PARAM;
+            }
+        }
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            /* The rows of the new layout, including the ones written through the context
+             * after the migration, are told apart by the id of the layout
+             */
+            context->layoutId = GetLayoutId(context);
+            result = MigrateExtendedMode(&oldContext, context);
+            (void)DefineLastWrittenRow(context);
+        }
+    }
+    return result;
 }
 
 
 /*******************************************************************************
-* Function Name: CalcChecksum
+* Function Name: MigrateExtendedMode
 ****************************************************************************//**
 *
-* Implements CRC-8 used in the checksum calculation for the redundant copy
-* algorithm.
+* Moves the Em_EEPROM content from the old layout to the new one, or resumes
+* the interrupted migration. The state of the migration is defined by the rows
+* of both layouts:
+* * No rows of the new layout: the migration is not started. The content
+*   of the old layout is written to numberOfRows rows of the new layout.
+* * Fewer than numberOfRows rows of the new layout: the migration is
+*   interrupted. The writes continue from the last row written.
+* * Otherwise, the migration is complete or was not needed. The rows of other
+*   layouts left in the nvm of both layouts are erased.
 *
-* \param rowData
-* The row data to be used to calculate the checksum.
+* If the content of the old layout has a bad checksum, the rows of the new
+* layout are written, but the old layout is not erased until the next call.
 *
-* \param len
-* The length of rowData.
+* \param oldContext
+* The pointer to the Em_EEPROM context structure of the old layout.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure of the new layout.
 *
 * \return
-* The calculated value of CRC-8.
+* This function returns cy_en_em_eeprom_status_t.
 *
 *******************************************************************************/
-static uint8_t CalcChecksum(const uint8_t rowData[], uint32_t len)
+static cy_en_em_eeprom_status_t MigrateExtendedMode(
+    cy_stc_eeprom_context_t* oldContext,
+    cy_stc_eeprom_context_t* context)
 {
-    uint8_t crc = CY_EM_EEPROM_CRC8_SEED;
-    uint8_t i;
-    uint16_t cnt = 0u;
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    const cy_stc_eeprom_context_t* layouts[2u];
+    uint64_t layoutSeqNum = (uint64_t)context->layoutId << CY_EM_EEPROM_SEQ_NUM_LAYOUT_POS;
+    uint64_t seqNum;
+    uint64_t newSeqNumMin = UINT64_MAX;
+    uint64_t newSeqNumMax = 0u;
+    uint64_t oldSeqNumMax = 0u;
+    uint32_t newRowAddrMin = context->userNvmStartAddr;
+    uint32_t rowAddr;
+    uint32_t i;
 
-    while (cnt != len)
+    /* 1. Finds the rows of the new layout and the last written row of the old one.
+     * The rows in the nvm of both layouts are read once.
+     */
+    layouts[0u] = context;
+    layouts[1u] = oldContext;
+    for (i = 0u; i < 2u; i++)
     {
-        crc ^= rowData[cnt];
-        for (i = 0u; i < CY_EM_EEPROM_CRC8_POLYNOM_LEN; i++)
+        for (rowAddr = layouts[i]->userNvmStartAddr; rowAddr < GetLayoutEndAddr(layouts[i]);
+             rowAddr += context->rowSize)
         {
-            crc = CY_EM_EEPROM_CALCULATE_CRC8(crc);
+            if ((0u == i) || (!IsInLayout(rowAddr, context)))
+            {
+                seqNum = ReadValidSeqNum(rowAddr, context);
+                if ((layoutSeqNum == (seqNum & ~CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK)) &&
+                    IsInLayout(rowAddr, context))
+                {
+                    if (seqNum < newSeqNumMin)
+                    {
+                        newSeqNumMin = seqNum;
+                        newRowAddrMin = GetRingRowAddr(rowAddr, context);
+                    }
+                    newSeqNumMax = (seqNum > newSeqNumMax) ? seqNum : newSeqNumMax;
+                }
+                else if ((seqNum > oldSeqNumMax) && IsInLayout(rowAddr, oldContext))
+                {
+                    /* The rows of the new layout are ignored, as they may have greater
+                     * sequence numbers than the rows of the old layout.
+                     */
+                    oldSeqNumMax = seqNum;
+                    oldContext->lastWrittenRowAddr = GetRingRowAddr(rowAddr, oldContext);
+                }
+                else
+                {
+                    /* Neither the last row of the old layout nor a row of the new one */
+                }
+            }
         }
-        cnt++;
     }
 
-    return (crc);
+    /* 2. Writes the rows of the new layout. The old layout is not written after
+     * the migration is started, so while the old layout has rows, the rows of the new
+     * layout are the rows written by the migration.
+     */
+    if ((0u != oldSeqNumMax) && (0u == newSeqNumMax))
+    {
+        result = PlaceMigrationRows(&newRowAddrMin, oldContext, context);
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            /* Keeps the number of writes of the old layout */
+            (void)CheckLastWrittenRowIntegrity(&seqNum, oldContext);
+            result = WriteMigrationRows(newRowAddrMin, 1u,
+                                        layoutSeqNum | (seqNum & CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK),
+                                        oldContext, context);
+        }
+    }
+    else if ((0u != oldSeqNumMax) && ((newSeqNumMax - newSeqNumMin) < (context->numberOfRows - 1u)))
+    {
+        /* Writes the last row again, as its redundant copy may be incomplete */
+        result = WriteMigrationRows(newRowAddrMin, (uint32_t)((newSeqNumMax - newSeqNumMin) + 1u),
+                                    newSeqNumMin - 1u, oldContext, context);
+    }
+    else
+    {
+        /* All rows of the new layout are written */
+    }
+
+    /* 3. Erases the old layout. It is kept if its content has a bad checksum, so
+     * the content can still be read with the old configuration.
+     */
+    if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        if (CY_EM_EEPROM_SUCCESS != EraseOtherLayoutRows(oldContext, context))
+        {
+            result = CY_EM_EEPROM_WRITE_FAIL;
+        }
+    }
+
+    return result;
 }
 
 
 /*******************************************************************************
-* Function Name: CheckRanges
+* Function Name: PlaceMigrationRows
 ****************************************************************************//**
 *
-* Checks the provided configuration for parameter validness and size of
-* the requested nvm.
+* Finds numberOfRows consecutive rows of the new ring which are outside
+* the rows the old layout reads: its last numberOfRows written rows and their
+* redundant copies. If there are no such rows, the old window is moved along
+* the old ring with writes of the unchanged data, as few as needed. Nothing is
+* written if no position of the old window leaves the space.
+*
+* \param firstRowAddr
+* The pointer to store the address of the first migration row.
+*
+* \param oldContext
+* The pointer to the Em_EEPROM context structure of the old layout.
 *
-* \param config
-* The pointer to a configuration structure. See \ref cy_stc_eeprom_config2_t.
-
 * \param context
-* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+* The pointer to the Em_EEPROM context structure of the new layout.
 *
 * \return
-* Returns the status of operation. See cy_en_em_eeprom_status_t.
+* This function returns cy_en_em_eeprom_status_t.
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t CheckRanges(
-    const cy_stc_eeprom_config2_t* config,
+static cy_en_em_eeprom_status_t PlaceMigrationRows(
+    uint32_t* firstRowAddr,
+    cy_stc_eeprom_context_t* oldContext,
     const cy_stc_eeprom_context_t* context)
 {
-    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_DATA;
-    const cy_stc_eeprom_config2_t* cfg = config;
-    bool isInRange = false;
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    uint32_t oldRowAddr = oldContext->lastWrittenRowAddr;
+    uint32_t oldFirstRowAddr;
+    uint32_t numAdvances = 0u;
+    uint32_t rowAddr;
+    uint32_t ringIndex;
+    uint32_t i;
+    bool isFree = false;
+    uint8_t value;
 
-    /* Checks the parameter validness */
-    if ((0u != cfg->userNvmStartAddr) &&
-        (0u != cfg->eepromSize) &&
-        (1u >= cfg->simpleMode) &&
-        (1u >= cfg->blockingWrite) &&
-        (1u >= cfg->redundantCopy) &&
-        (0u < cfg->wearLevelingFactor) &&
-        (CY_EM_EEPROM_MAX_WEAR_LEVELING_FACTOR >= cfg->wearLevelingFactor))
+    while ((!isFree) && (numAdvances < oldContext->wearLevelingRows))
     {
-        /* Checks the nvm size and location */
-        uint32_t startAddr = cfg->userNvmStartAddr;
-        uint32_t size = GetPhysicalSize(context, config);
+        oldFirstRowAddr = GetPrevRowAddr(oldRowAddr, oldContext->numberOfRows - 1u, oldContext);
 
-        isInRange = context->bd->is_in_range(context->bd->context, startAddr, size);
+        for (ringIndex = 0u; (!isFree) && (ringIndex < context->wearLevelingRows); ringIndex++)
+        {
+            *firstRowAddr = context->userNvmStartAddr + (ringIndex * context->rowSize);
+            rowAddr = *firstRowAddr;
+            isFree = true;
+            for (i = 0u; isFree && (i < context->numberOfRows); i++)
+            {
+                isFree = (!IsInWindow(rowAddr, oldFirstRowAddr, oldContext->numberOfRows,
+                                      oldContext)) &&
+                         ((0u == context->redundantCopy) ||
+                          (!IsInWindow(GetRedundantRowAddr(rowAddr, context), oldFirstRowAddr,
+                                       oldContext->numberOfRows, oldContext)));
+                rowAddr = GetNextRowAddr(rowAddr, context);
+            }
+        }
+        if (!isFree)
+        {
+            oldRowAddr = GetNextRowAddr(oldRowAddr, oldContext);
+            numAdvances++;
+        }
+    }
+
+    if (!isFree)
+    {
+        result = CY_EM_EEPROM_NO_SPACE;
+    }
+    for (i = 0u; (i < numAdvances) && (CY_EM_EEPROM_SUCCESS == result); i++)
+    {
+        (void)ReadExtendedMode(0u, &value, 1u, oldContext);
+        result = WriteExtendedMode(0u, &value, 1u, oldContext);
     }
-    result = isInRange ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_BAD_DATA;
 
     return result;
 }
 
 
 /*******************************************************************************
-* Function Name: WriteRow
+* Function Name: WriteMigrationRows
 ****************************************************************************//**
 *
-* Writes one nvm row starting from the specified row address.
+* Writes the content of the old layout to the rows of the new layout from
+* the specified one to numberOfRows, as Cy_Em_EEPROM_WriteImage() does. Each
+* row gets the content of its historic data slot and an empty header. The part
+* of the content beyond the old eepromSize is zero.
 *
-* \param rowAddr
-* The pointer to the nvm row.
+* \param firstRowAddr
+* The address of the first migration row.
 *
-* \param rowData
-* The pointer to the data to be written to the row.
+* \param firstRow
+* The number of the row to start from, 1 for the first migration row.
+*
+* \param baseSeqNum
+* The sequence number preceding the first migration row.
+*
+* \param oldContext
+* The pointer to the Em_EEPROM context structure of the old layout.
 *
 * \param context
-* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+* The pointer to the Em_EEPROM context structure of the new layout.
 *
 * \return
-* Returns the status of operation. See cy_en_em_eeprom_status_t.
+* This function returns cy_en_em_eeprom_status_t. CY_EM_EEPROM_BAD_CHECKSUM
+* is returned if the rows are written but the old content has a bad checksum.
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t WriteRow(
-    uint32_t* const rowAddr,
-    const uint32_t* rowData,
+static cy_en_em_eeprom_status_t WriteMigrationRows(
+    uint32_t firstRowAddr,
+    uint32_t firstRow,
+    uint64_t baseSeqNum,
+    cy_stc_eeprom_context_t* oldContext,
     const cy_stc_eeprom_context_t* context)
 {
     cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
-    cy_rslt_t writeResult = CY_RSLT_SUCCESS;
-    bool isEraseRequired = context->bd->is_erase_required;
+    cy_en_em_eeprom_status_t readResult = CY_EM_EEPROM_SUCCESS;
+    uint64_t seqNum;
+    uint32_t rowAddr;
+    uint32_t slotAddr;
+    uint32_t sizeToCopy;
+    uint32_t i;
 
-    if (0u != context->blockingWrite)
-    {
-        if (isEraseRequired)
-        {
-            writeResult = context->bd->erase(context->bd->context,
-                                             ((uint32_t)rowAddr),
-                                             context->rowSize);
-        }
-        if (result == CY_RSLT_SUCCESS)
-        {
-            writeResult = context->bd->program(context->bd->context,
-                                               ((uint32_t)rowAddr),
-                                               context->rowSize,
-                                               (uint8_t*)rowData);
-        }
-    }
-    #if defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED)
-    else
+    rowAddr = GetPrevRowAddr(firstRowAddr, context->wearLevelingRows - (firstRow - 1u), context);
+
+    for (i = firstRow; (i <= context->numberOfRows) && (CY_EM_EEPROM_SUCCESS == result); i++)
     {
-        if (isEraseRequired)
+        seqNum = baseSeqNum + i;
+
+        (void)memset(&writeRamBuffer[0u], 0, (context->rowSize));
+        SetSeqNum(&writeRamBuffer[0u], seqNum);
+
+        slotAddr = GetHistoricSlot(rowAddr, seqNum, context) * context->byteInRow;
+        if (slotAddr < oldContext->eepromSize)
         {
-            writeResult = context->bd->erase_nb(context->bd->context,
-                                                ((uint32_t)rowAddr),
-                                                context->rowSize);
+            sizeToCopy = oldContext->eepromSize - slotAddr;
+            sizeToCopy = (sizeToCopy < context->byteInRow) ? sizeToCopy : context->byteInRow;
+            sizeToCopy = ((slotAddr + sizeToCopy) < context->eepromSize) ? sizeToCopy :
+                         (context->eepromSize - slotAddr);
+            if (CY_EM_EEPROM_BAD_CHECKSUM ==
+                ReadExtendedMode(slotAddr, &((uint8_t*)&writeRamBuffer[0u])[context->byteInRow],
+                                 sizeToCopy, oldContext))
+            {
+                readResult = CY_EM_EEPROM_BAD_CHECKSUM;
+            }
         }
-        if (result == CY_RSLT_SUCCESS)
+
+        writeRamBuffer[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] |= CalculateRowChecksum(
+            &writeRamBuffer[0u], (context->rowSize));
+
+        result = WriteRow(rowAddr, &writeRamBuffer[0u], context);
+        if ((CY_EM_EEPROM_SUCCESS == result) && (0u != context->redundantCopy))
         {
-            writeResult = context->bd->program_nb(context->bd->context,
-                                                  ((uint32_t)rowAddr),
-                                                  context->rowSize,
-                                                  (uint8_t*)rowData);
+            result = WriteRow(GetRedundantRowAddr(rowAddr, context), &writeRamBuffer[0u],
+                              context);
         }
+        rowAddr = GetNextRowAddr(rowAddr, context);
     }
-    #endif /* defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED) */
 
-    result  = ((writeResult == CY_RSLT_SUCCESS) ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_WRITE_FAIL);
-    return result;
+    return ((CY_EM_EEPROM_SUCCESS == result) ? readResult : result);
+}
+
+
+/*******************************************************************************
+* Function Name: EraseOtherLayoutRows
+****************************************************************************//**
+*
+* Erases the rows with a valid checksum and the layout id other than the one
+* of the new layout in the nvm of both layouts. Erased and damaged rows are
+* not touched.
+*
+* \param oldContext
+* The pointer to the Em_EEPROM context structure of the old layout.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure of the new layout.
+*
+* \return
+* Returns the status of operation. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t EraseOtherLayoutRows(
+    const cy_stc_eeprom_context_t* oldContext,
+    const cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    const cy_stc_eeprom_context_t* layouts[2u];
+    uint64_t layoutSeqNum = (uint64_t)context->layoutId << CY_EM_EEPROM_SEQ_NUM_LAYOUT_POS;
+    uint64_t seqNum;
+    uint32_t rowAddr;
+    uint32_t i;
+
+    (void)memset(&writeRamBuffer[0u], 0, (context->rowSize));
+    layouts[0u] = context;
+    layouts[1u] = oldContext;
+    for (i = 0u; (i < 2u) && (CY_EM_EEPROM_SUCCESS == result); i++)
+    {
+        for (rowAddr = layouts[i]->userNvmStartAddr;
+             (rowAddr < GetLayoutEndAddr(layouts[i])) && (CY_EM_EEPROM_SUCCESS == result);
+             rowAddr += context->rowSize)
+        {
+            if ((0u == i) || (!IsInLayout(rowAddr, context)))
+            {
+                seqNum = ReadValidSeqNum(rowAddr, context);
+                if ((0u != seqNum) &&
+                    (layoutSeqNum != (seqNum & ~CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK)))
+                {
+                    result = EraseRow(rowAddr, &writeRamBuffer[0u], context);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_NumWrites
+//--------------------------------------------------------------------------------------------------
+uint32_t Cy_Em_EEPROM_NumWrites(cy_stc_eeprom_context_t* context)
+{
+    return ((uint32_t)Cy_Em_EEPROM_NumWrites64(context));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_NumWrites64
+//--------------------------------------------------------------------------------------------------
+uint64_t Cy_Em_EEPROM_NumWrites64(cy_stc_eeprom_context_t* context)
+{
+    uint64_t seqNum;
+
+    StartOperation(context);
+    (void)CheckLastWrittenRowIntegrity(&seqNum, context);
+
+    return (seqNum & CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_GetRowWear
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_GetRowWear(
+    uint32_t* rowWrites,
+    uint32_t numRows,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    uint64_t seqNum;
+    uint32_t i;
+
+    if ((NULL != rowWrites) && (0u == context->simpleMode) &&
+        (numRows >= context->wearLevelingRows))
+    {
+        StartOperation(context);
+        (void)CheckLastWrittenRowIntegrity(&seqNum, context);
+
+        for (i = 0u; i < context->wearLevelingRows; i++)
+        {
+            rowWrites[i] = GetRowWriteCount(i, seqNum, context);
+        }
+        result = CY_EM_EEPROM_SUCCESS;
+    }
+    return (result);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_GetRemainingLife
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_GetRemainingLife(
+    uint32_t cycleRating,
+    uint64_t* remainingWrites,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    uint64_t seqNum;
+    uint64_t rowRemaining;
+    uint64_t minRemaining = UINT64_MAX;
+    uint32_t ringRows = context->wearLevelingRows;
+    uint32_t lastIndex;
+    uint32_t writeCount;
+    uint32_t i;
+
+    if ((NULL != remainingWrites) && (0u == context->simpleMode))
+    {
+        StartOperation(context);
+        (void)CheckLastWrittenRowIntegrity(&seqNum, context);
+        lastIndex = GetRowIndex(context->lastWrittenRowAddr, context);
+
+        for (i = 0u; i < ringRows; i++)
+        {
+            writeCount = GetRowWriteCount(i, seqNum, context);
+            rowRemaining = 0u;
+            if (writeCount <= cycleRating)
+            {
+                /* The row is written again after the rows which follow the last written row
+                 * and precede it in the ring order, then once per ring pass.
+                 */
+                rowRemaining = ((uint64_t)(cycleRating - writeCount) * ringRows) +
+                               ((((i + ringRows) - lastIndex) - 1u) % ringRows);
+            }
+            if (rowRemaining < minRemaining)
+            {
+                minRemaining = rowRemaining;
+            }
+        }
+        *remainingWrites = minRemaining;
+        result = CY_EM_EEPROM_SUCCESS;
+    }
+    return (result);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_ScrubStep
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_ScrubStep(
+    uint32_t numRows,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    cy_en_em_eeprom_status_t retScrub;
+    uint32_t i;
+    uint32_t rowAddr;
+
+    if ((NULL != context) && (0u == context->simpleMode))
+    {
+        StartOperation(context);
+        result = CY_EM_EEPROM_SUCCESS;
+
+        for (i = 0u; (i < numRows) && (i < context->wearLevelingRows); i++)
+        {
+            if (context->scrubRowIndex >= context->wearLevelingRows)
+            {
+                context->scrubRowIndex = 0u;
+            }
+            rowAddr = context->userNvmStartAddr + (context->scrubRowIndex * context->rowSize);
+            retScrub = ScrubRow(rowAddr, context);
+            context->scrubRowIndex++;
+
+            /* Reports the status in the following order:
+             * The highest priority: CY_EM_EEPROM_WRITE_FAIL
+             *                       CY_EM_EEPROM_BAD_CHECKSUM
+             *                       CY_EM_EEPROM_REDUNDANT_COPY_USED
+             * The lowest priority:  CY_EM_EEPROM_SUCCESS
+             */
+            if ((CY_EM_EEPROM_WRITE_FAIL == retScrub) ||
+                ((CY_EM_EEPROM_BAD_CHECKSUM == retScrub) && (CY_EM_EEPROM_WRITE_FAIL != result)) ||
+                (CY_EM_EEPROM_SUCCESS == result))
+            {
+                result = retScrub;
+            }
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_RegionRead
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_RegionRead(
+    uint32_t addr,
+    void* eepromData,
+    uint32_t size,
+    const cy_stc_em_eeprom_region_t* regions,
+    uint32_t numRegions)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    cy_en_em_eeprom_status_t retPart;
+    const cy_stc_em_eeprom_region_t* region;
+    uint8_t* userBufferAddr_p = eepromData;
+    uint32_t currentAddr = addr;
+    uint32_t sizeRemaining = size;
+    uint32_t partSize = 0u;
+
+    if ((0u != size) && (NULL != eepromData) && (NULL != regions))
+    {
+        result = CY_EM_EEPROM_SUCCESS;
+        while ((0u != sizeRemaining) && ((CY_EM_EEPROM_SUCCESS == result) ||
+                                         (CY_EM_EEPROM_REDUNDANT_COPY_USED == result) ||
+                                         (CY_EM_EEPROM_BAD_CHECKSUM == result)))
+        {
+            /* Each part is read from the instance storing its region */
+            region = FindRegion(currentAddr, sizeRemaining, regions, numRegions, &partSize);
+            retPart = CY_EM_EEPROM_BAD_PARAM;
+            if (NULL != region)
+            {
+                retPart = Cy_Em_EEPROM_Read(region->instanceAddr + (currentAddr - region->addr),
+                                            userBufferAddr_p, partSize, region->context);
+            }
+            result = MergeRegionStatus(result, retPart);
+            userBufferAddr_p = &userBufferAddr_p[partSize];
+            currentAddr += partSize;
+            sizeRemaining -= partSize;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_RegionWrite
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_RegionWrite(
+    uint32_t addr,
+    const void* eepromData,
+    uint32_t size,
+    const cy_stc_em_eeprom_region_t* regions,
+    uint32_t numRegions)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    cy_en_em_eeprom_status_t retPart;
+    const cy_stc_em_eeprom_region_t* region;
+    const uint8_t* ptrUserData = eepromData;
+    uint32_t currentAddr = addr;
+    uint32_t sizeRemaining = size;
+    uint32_t partSize = 0u;
+
+    if ((0u != size) && (NULL != eepromData) && (NULL != regions))
+    {
+        result = CY_EM_EEPROM_SUCCESS;
+        while ((0u != sizeRemaining) && ((CY_EM_EEPROM_SUCCESS == result) ||
+                                         (CY_EM_EEPROM_REDUNDANT_COPY_USED == result) ||
+                                         (CY_EM_EEPROM_BAD_CHECKSUM == result)))
+        {
+            /* Each part is written to the instance storing its region only, so the rows of
+             * the other instances are not rewritten
+             */
+            region = FindRegion(currentAddr, sizeRemaining, regions, numRegions, &partSize);
+            retPart = CY_EM_EEPROM_BAD_PARAM;
+            if (NULL != region)
+            {
+                retPart = Cy_Em_EEPROM_Write(region->instanceAddr + (currentAddr - region->addr),
+                                             ptrUserData, partSize, region->context);
+            }
+            result = MergeRegionStatus(result, retPart);
+            ptrUserData = &ptrUserData[partSize];
+            currentAddr += partSize;
+            sizeRemaining -= partSize;
+        }
+    }
+
+    return result;
+}
+
+
+#if (CY_EM_EEPROM_KV_ENABLE == 1u)
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_KvInit
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvInit(
+    cy_stc_em_eeprom_kv_entry_t* index,
+    uint32_t indexSize,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    cy_en_em_eeprom_status_t retRead;
+    cy_en_em_eeprom_status_t retWrite = CY_EM_EEPROM_SUCCESS;
+    cy_stc_em_eeprom_kv_entry_t* entry;
+    uint8_t recordHeader[CY_EM_EEPROM_KV_RECORD_HEADER_SIZE];
+    uint32_t addr = 0u;
+    uint32_t size;
+    uint16_t key;
+    bool isEnd = false;
+
+    if ((NULL != index) && (0u != indexSize) && (NULL != context))
+    {
+        context->kvIndex = index;
+        context->kvIndexSize = indexSize;
+        context->kvNumRecords = 0u;
+        result = CY_EM_EEPROM_SUCCESS;
+
+        while ((!isEnd) && ((addr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE) < context->eepromSize))
+        {
+            retRead = Cy_Em_EEPROM_Read(addr, recordHeader, CY_EM_EEPROM_KV_RECORD_HEADER_SIZE,
+                                        context);
+            key = (uint16_t)((uint32_t)recordHeader[0u] | ((uint32_t)recordHeader[1u] << 8u));
+            size = (uint32_t)recordHeader[2u] | ((uint32_t)recordHeader[3u] << 8u);
+
+            if ((CY_EM_EEPROM_KV_KEY_END == key) || (0u == size) ||
+                ((addr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + size) > context->eepromSize))
+            {
+                /* An erased or incomplete record ends the list */
+                isEnd = true;
+            }
+            else if (context->kvNumRecords >= context->kvIndexSize)
+            {
+                result = CY_EM_EEPROM_NO_SPACE;
+                isEnd = true;
+            }
+            else
+            {
+                if (CY_EM_EEPROM_KV_KEY_DELETED != key)
+                {
+                    entry = KvFindEntry(key, 0u, context);
+                    if (NULL != entry)
+                    {
+                        /* Completes a change of the value interrupted by a reset. A new record
+                         * of an existing key always follows the previous one, so it is the later
+                         * one. A record moved by the compaction has the same value in both.
+                         */
+                        if (CY_EM_EEPROM_SUCCESS != KvWriteRecordHeader(
+                                entry->addr, CY_EM_EEPROM_KV_KEY_DELETED, entry->size, context))
+                        {
+                            retWrite = CY_EM_EEPROM_WRITE_FAIL;
+                        }
+                        entry->key = CY_EM_EEPROM_KV_KEY_DELETED;
+                    }
+                }
+
+                entry = &context->kvIndex[context->kvNumRecords];
+                entry->key = key;
+                entry->size = (uint16_t)size;
+                entry->addr = addr;
+                context->kvNumRecords++;
+                addr += CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + size;
+
+                if (CY_EM_EEPROM_BAD_CHECKSUM == retRead)
+                {
+                    result = CY_EM_EEPROM_BAD_CHECKSUM;
+                }
+                if (CY_EM_EEPROM_SUCCESS == result)
+                {
+                    result = retRead;
+                }
+            }
+        }
+        context->kvFreeAddr = addr;
+
+        if (CY_EM_EEPROM_NO_SPACE == result)
+        {
+            /* The records after the index would be overwritten by the new records */
+            context->kvIndex = NULL;
+        }
+        else if (CY_EM_EEPROM_SUCCESS != retWrite)
+        {
+            /* The index is complete, but the nvm keeps the previous record */
+            result = retWrite;
+        }
+        else
+        {
+            /* The store is initialized */
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_KvSet
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvSet(
+    uint16_t key,
+    const void* data,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    cy_stc_em_eeprom_kv_entry_t* entry;
+    uint32_t minAddr = 0u;
+    uint32_t freeAddr;
+
+    if ((CY_EM_EEPROM_KV_KEY_END != key) && (CY_EM_EEPROM_KV_KEY_MAX >= key) && (NULL != data) &&
+        (0u != size) && (CY_EM_EEPROM_KV_SIZE_MAX >= size) && (NULL != context) &&
+        (NULL != context->kvIndex))
+    {
+        entry = KvFindEntry(key, 0u, context);
+        if ((NULL != entry) && (entry->size == size) &&
+            ((0u != context->simpleMode) || (size <= context->headerDataLength)))
+        {
+            /* Only the value of the existing record is written. With Simple mode disabled, it
+             * fits in one header, so the change is one row write.
+             */
+            result = KvWrite(entry->addr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, data, size,
+                             context);
+        }
+        else if ((NULL != entry) && (entry->size == size) &&
+                 KvIsValueEqual(entry->addr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, data, size,
+                                context))
+        {
+            /* An unchanged value is not written */
+            result = CY_EM_EEPROM_SUCCESS;
+        }
+        else
+        {
+            if (NULL != entry)
+            {
+                /* The new record of an existing key follows the previous one, so
+                 * Cy_Em_EEPROM_KvInit() keeps the new one if a reset interrupts the change.
+                 */
+                minAddr = entry->addr + 1u;
+            }
+            result = KvAddRecord(key, data, 0u, size, minAddr, context);
+            freeAddr = context->kvFreeAddr + 1u;
+            while ((CY_EM_EEPROM_NO_SPACE == result) && (context->kvFreeAddr < freeAddr))
+            {
+                /* The compaction moves the records, so the previous record is found again. It
+                 * is repeated while it frees the space at the end, as the relocated records
+                 * may leave new deleted records to reclaim.
+                 */
+                freeAddr = context->kvFreeAddr;
+                result = KvCompact(context);
+                if (CY_EM_EEPROM_SUCCESS == result)
+                {
+                    entry = KvFindEntry(key, 0u, context);
+                    minAddr = (NULL != entry) ? (entry->addr + 1u) : 0u;
+                    result = KvAddRecord(key, data, 0u, size, minAddr, context);
+                }
+            }
+            if ((CY_EM_EEPROM_SUCCESS == result) && (NULL != entry))
+            {
+                /* Deletes the previous record. It is found first as it precedes the new one. */
+                entry = KvFindEntry(key, 0u, context);
+                result = KvWriteRecordHeader(entry->addr, CY_EM_EEPROM_KV_KEY_DELETED,
+                                             entry->size, context);
+                entry->key = CY_EM_EEPROM_KV_KEY_DELETED;
+            }
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_KvGet
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvGet(
+    uint16_t key,
+    void* data,
+    uint32_t* size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    const cy_stc_em_eeprom_kv_entry_t* entry;
+
+    if ((CY_EM_EEPROM_KV_KEY_END != key) && (CY_EM_EEPROM_KV_KEY_MAX >= key) && (NULL != data) &&
+        (NULL != size) && (NULL != context) && (NULL != context->kvIndex))
+    {
+        entry = KvFindEntry(key, 0u, context);
+        if (NULL == entry)
+        {
+            result = CY_EM_EEPROM_KEY_NOT_FOUND;
+        }
+        else
+        {
+            if (*size >= entry->size)
+            {
+                result = Cy_Em_EEPROM_Read(entry->addr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, data,
+                                           entry->size, context);
+            }
+            *size = entry->size;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_KvDelete
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvDelete(uint16_t key, cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+    cy_stc_em_eeprom_kv_entry_t* entry;
+
+    if ((CY_EM_EEPROM_KV_KEY_END != key) && (CY_EM_EEPROM_KV_KEY_MAX >= key) &&
+        (NULL != context) && (NULL != context->kvIndex))
+    {
+        entry = KvFindEntry(key, 0u, context);
+        if (NULL == entry)
+        {
+            result = CY_EM_EEPROM_KEY_NOT_FOUND;
+        }
+        else
+        {
+            result = KvWriteRecordHeader(entry->addr, CY_EM_EEPROM_KV_KEY_DELETED, entry->size,
+                                         context);
+            if (CY_EM_EEPROM_SUCCESS == result)
+            {
+                entry->key = CY_EM_EEPROM_KV_KEY_DELETED;
+            }
+        }
+    }
+
+    return result;
+}
+
+
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+
+#if (CY_EM_EEPROM_STATS_ENABLE == 1u)
+//--------------------------------------------------------------------------------------------------
+// Cy_Em_EEPROM_GetStats
+//--------------------------------------------------------------------------------------------------
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_GetStats(
+    const cy_stc_eeprom_context_t* context,
+    cy_stc_em_eeprom_stats_t* stats)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_PARAM;
+
+    if ((NULL != context) && (NULL != stats))
+    {
+        (void)memcpy((void*)stats, (const void*)&context->stats, sizeof(cy_stc_em_eeprom_stats_t));
+        result = CY_EM_EEPROM_SUCCESS;
+    }
+    return (result);
+}
+
+
+#endif /* (CY_EM_EEPROM_STATS_ENABLE == 1u) */
+
+
+/*******************************************************************************
+* Function Name: CalcChecksum
+****************************************************************************//**
+*
+* Implements CRC-8 used in the checksum calculation for the redundant copy
+* algorithm.
+*
+* \param rowData
+* The row data to be used to calculate the checksum.
+*
+* \param len
+* The length of rowData.
+*
+* \return
+* The calculated value of CRC-8.
+*
+*******************************************************************************/
+static uint8_t CalcChecksum(const uint8_t rowData[], uint32_t len)
+{
+    uint8_t crc = CY_EM_EEPROM_CRC8_SEED;
+    uint8_t i;
+    uint16_t cnt = 0u;
+
+    while (cnt != len)
+    {
+        crc ^= rowData[cnt];
+        for (i = 0u; i < CY_EM_EEPROM_CRC8_POLYNOM_LEN; i++)
+        {
+            crc = CY_EM_EEPROM_CALCULATE_CRC8(crc);
+        }
+        cnt++;
+    }
+
+    return (crc);
+}
+
+
+/*******************************************************************************
+* Function Name: CheckRanges
+****************************************************************************//**
+*
+* Checks the provided configuration for parameter validness and size of
+* the requested nvm.
+*
+* \param config
+* The pointer to a configuration structure. See \ref cy_stc_eeprom_config2_t.
+
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the status of operation. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t CheckRanges(
+    const cy_stc_eeprom_config2_t* config,
+    const cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_DATA;
+    const cy_stc_eeprom_config2_t* cfg = config;
+    bool isInRange = false;
+
+    bool isWearLevelingValid;
+
+    if (0u == cfg->wearLevelingFactor)
+    {
+        /* wearLevelingRows is used only with wearLevelingFactor zero, which is not valid
+         * otherwise, so the configurations filled before it was added never read it. The ring
+         * must hold at least one row per each row of the Em_EEPROM data. The upper limit keeps
+         * the physical size within the address space, so the block device checks the whole
+         * range.
+         */
+        isWearLevelingValid = (context->numberOfRows <= cfg->wearLevelingRows) &&
+                              (cfg->wearLevelingRows <=
+                               ((UINT32_MAX - cfg->userNvmStartAddr) /
+                                ((0u != cfg->redundantCopy) ? (2u * context->rowSize) :
+                                 context->rowSize)));
+    }
+    else
+    {
+        /* The upper limit CY_EM_EEPROM_MAX_WEAR_LEVELING_FACTOR is the range of the type */
+        isWearLevelingValid = true;
+    }
+
+    /* Checks the parameter validness */
+    if ((0u != cfg->userNvmStartAddr) &&
+        (0u != cfg->eepromSize) &&
+        (1u >= cfg->simpleMode) &&
+        (1u >= cfg->blockingWrite) &&
+        (1u >= cfg->redundantCopy) &&
+        isWearLevelingValid)
+    {
+        /* Checks the nvm size and location */
+        uint32_t startAddr = cfg->userNvmStartAddr;
+        uint32_t size = GetPhysicalSize(context, config);
+
+        isInRange = context->bd->is_in_range(context->bd->context, startAddr, size);
+    }
+    result = isInRange ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_BAD_DATA;
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: WriteRow
+****************************************************************************//**
+*
+* Writes one nvm row starting from the specified row address.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param rowData
+* The pointer to the data to be written to the row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the status of operation. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t WriteRow(
+    uint32_t rowAddr,
+    const uint32_t* rowData,
+    const cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    cy_rslt_t writeResult = CY_RSLT_SUCCESS;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    InvalidateCachedRow(rowAddr);
+
+    if (context->bd->is_erase_required)
+    {
+        writeResult = BdEraseRow(rowAddr, context);
+    }
+    if (writeResult == CY_RSLT_SUCCESS)
+    {
+        writeResult = BdProgramRow(rowAddr, rowData, context);
+    }
+
+    CY_EM_EEPROM_STATS_ADD_TIME(timeProgram, startTime);
+    result  = ((writeResult == CY_RSLT_SUCCESS) ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_WRITE_FAIL);
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: EraseRow
+****************************************************************************//**
+*
+* Erases one nvm row starting from the specified row address. If the redundant
+* copy option is enabled, the corresponding row in the redundant copy will also
+* be erased.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+*
+* \param ramBuffAddr
+* The address of the RAM buffer that contains zeroed data.
+* Reserved for compatibility.
+*
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the status of operation. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t EraseRow(
+    uint32_t rowAddr,
+    const uint32_t* ramBuffAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_WRITE_FAIL;
+    cy_rslt_t eraseResult = CY_RSLT_SUCCESS;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    InvalidateCachedRow(rowAddr);
+
+    if (context->bd->is_erase_required)
+    {
+        eraseResult = BdEraseRow(rowAddr, context);
+    }
+    if (eraseResult == CY_RSLT_SUCCESS)
+    {
+        eraseResult = BdProgramRow(rowAddr, ramBuffAddr, context);
+    }
+
+    CY_EM_EEPROM_STATS_ADD_TIME(timeProgram, startTime);
+    result  = ((eraseResult == CY_RSLT_SUCCESS) ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_WRITE_FAIL);
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: BdRead
+****************************************************************************//**
+*
+* Reads data with the block device read function. All nvm reads of
+* the Em_EEPROM go through this function.
+*
+* \param addr
+* The block device address to read from.
+*
+* \param size
+* The number of bytes to read.
+*
+* \param data
+* The pointer to the buffer to store the data.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The result of the block device read function.
+*
+*******************************************************************************/
+static cy_rslt_t BdRead(
+    uint32_t addr,
+    uint32_t size,
+    uint8_t* data,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+    cy_rslt_t readResult = context->bd->read(context->bd->context, addr, size, data);
+
+    CY_EM_EEPROM_TRACE(CY_EM_EEPROM_TRACE_READ, addr, size, startTime);
+    CY_EM_EEPROM_STATS_ADD(bdReadBytes, size);
+    return (readResult);
+}
+
+
+/*******************************************************************************
+* Function Name: BdProgramRow
+****************************************************************************//**
+*
+* Programs one nvm row with the blocking or non-blocking block device program
+* function depending on the Em_EEPROM configuration.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param rowData
+* The pointer to the data to be written to the row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The result of the block device program function.
+*
+*******************************************************************************/
+static cy_rslt_t BdProgramRow(
+    uint32_t rowAddr,
+    const uint32_t* rowData,
+    const cy_stc_eeprom_context_t* context)
+{
+    cy_rslt_t programResult = CY_RSLT_SUCCESS;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    if (0u != context->blockingWrite)
+    {
+        programResult = context->bd->program(context->bd->context, rowAddr, context->rowSize,
+                                             (const uint8_t*)rowData);
+        CY_EM_EEPROM_TRACE(CY_EM_EEPROM_TRACE_PROGRAM, rowAddr, context->rowSize, startTime);
+    }
+    #if defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED)
+    else
+    {
+        programResult = context->bd->program_nb(context->bd->context, rowAddr, context->rowSize,
+                                                (const uint8_t*)rowData);
+        CY_EM_EEPROM_TRACE(CY_EM_EEPROM_TRACE_PROGRAM_NB, rowAddr, context->rowSize, startTime);
+    }
+    #endif /* defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED) */
+    CY_EM_EEPROM_STATS_ADD(rowsProgrammed, 1u);
+    return (programResult);
+}
+
+
+/*******************************************************************************
+* Function Name: BdEraseRow
+****************************************************************************//**
+*
+* Erases one nvm row with the blocking or non-blocking block device erase
+* function depending on the Em_EEPROM configuration.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The result of the block device erase function.
+*
+*******************************************************************************/
+static cy_rslt_t BdEraseRow(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    cy_rslt_t eraseResult = CY_RSLT_SUCCESS;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    if (0u != context->blockingWrite)
+    {
+        eraseResult = context->bd->erase(context->bd->context, rowAddr, context->rowSize);
+        CY_EM_EEPROM_TRACE(CY_EM_EEPROM_TRACE_ERASE, rowAddr, context->rowSize, startTime);
+    }
+    #if defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED)
+    else
+    {
+        eraseResult = context->bd->erase_nb(context->bd->context, rowAddr, context->rowSize);
+        CY_EM_EEPROM_TRACE(CY_EM_EEPROM_TRACE_ERASE_NB, rowAddr, context->rowSize, startTime);
+    }
+    #endif /* defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED) */
+    CY_EM_EEPROM_STATS_ADD(rowsErased, 1u);
+    return (eraseResult);
+}
+
+
+/*******************************************************************************
+* Function Name: CalculateRowChecksum
+****************************************************************************//**
+*
+* Calculates a checksum of the row specified by the ptrRow parameter.
+* The first four bytes of the row are overwritten with zeros for calculation
+* since it is the checksum location.
+*
+* \param ptrRow
+* The pointer to a row.
+*
+* \param rowSize
+* The size of the row passed in.
+*
+* \return
+* The calculated value of CRC-8.
+*
+*******************************************************************************/
+static uint32_t CalculateRowChecksum(const uint32_t* ptrRow, uint32_t rowSize)
+{
+    CY_EM_EEPROM_STATS_ADD(crcBytes, (rowSize) - CY_EM_EEPROM_U32);
+    return ((uint32_t)CalcChecksum(&((const uint8_t*)ptrRow)[1u],
+                                   (rowSize) - CY_EM_EEPROM_U32));
+}
+
+
+/*******************************************************************************
+* Function Name: GetStoredRowChecksum
+****************************************************************************//**
+*
+* Returns the stored in the row checksum. The row specified by the ptrRow parameter.
+* The first byte of the row is the checksum. The other three bytes of the first
+* word hold the upper part of the sequence number.
+*
+* \param ptrRow
+* The pointer to a row.
+*
+* \return
+* The stored row checksum.
+*
+*******************************************************************************/
+static uint32_t GetStoredRowChecksum(const uint32_t* ptrRow)
+{
+    return (ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] & CY_EM_EEPROM_HEADER_CHECKSUM_MASK);
+}
+
+
+/*******************************************************************************
+* Function Name: CheckRowChecksum
+****************************************************************************//**
+*
+* Checks if the specified row has a valid stored CRC. A row with bits 32..55
+* of the sequence number all ones is never written by the library, so such
+* a row, for example erased to ones, has a bad CRC.
+*
+* \param ptrRow
+* The pointer to a row. NULL is treated as a row with a bad CRC.
+*
+* \param rowSize
+* The size of the row passed in.
+*
+* \return
+* Returns the operation status. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t CheckRowChecksum(const uint32_t* ptrRow, uint32_t rowSize)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_CHECKSUM;
+
+    if ((NULL != ptrRow) &&
+        (CY_EM_EEPROM_SEQ_NUM_HIGH_MASK != (ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] >>
+                                            CY_EM_EEPROM_HEADER_SEQ_NUM_HIGH_POS)) &&
+        (GetStoredRowChecksum(ptrRow) == CalculateRowChecksum(ptrRow, rowSize)))
+    {
+        result = CY_EM_EEPROM_SUCCESS;
+    }
+    return (result);
+}
+
+
+/*******************************************************************************
+* Function Name: GetStoredSeqNum
+****************************************************************************//**
+*
+* Returns the stored in the row seqNum (Sequence Number).
+* The row specified by ptrRow parameter.
+* The second four bytes of the row is the lower part of the seqNum. The upper
+* part is stored in the three bytes of the first word that follow the checksum.
+* Rows written by versions before 2.50 have the upper part equal to zero.
+*
+* \param ptrRow
+* The pointer to a row.
+*
+* \return
+* The stored sequence number.
+*
+*******************************************************************************/
+static uint64_t GetStoredSeqNum(const uint32_t* ptrRow)
+{
+    uint32_t seqNumLow = ptrRow[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32];
+    uint32_t seqNumHigh = ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] >>
+                          CY_EM_EEPROM_HEADER_SEQ_NUM_HIGH_POS;
+
+    return ((((uint64_t)seqNumHigh) << 32u) | seqNumLow);
+}
+
+
+/*******************************************************************************
+* Function Name: SetSeqNum
+****************************************************************************//**
+*
+* Stores the seqNum (Sequence Number) into the row buffer. The checksum byte
+* of the row buffer must be cleared and the checksum must be calculated after
+* this function as the upper part of the seqNum is covered by the checksum.
+*
+* \param ptrRow
+* The pointer to a row buffer in RAM.
+*
+* \param seqNum
+* The sequence number to store.
+*
+*******************************************************************************/
+static void SetSeqNum(uint32_t* ptrRow, uint64_t seqNum)
+{
+    ptrRow[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32] = (uint32_t)seqNum;
+    ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32] =
+        ((uint32_t)(seqNum >> 32u) & CY_EM_EEPROM_SEQ_NUM_HIGH_MASK) <<
+        CY_EM_EEPROM_HEADER_SEQ_NUM_HIGH_POS;
+}
+
+
+/*******************************************************************************
+* Function Name: DefineLastWrittenRow
+****************************************************************************//**
+*
+* Performs a search of the last written row address of the Em_EEPROM associated
+* with the context structure. If there were no writes to the Em_EEPROM, the
+* the Em_EEPROM start address is used.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the operation status. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t DefineLastWrittenRow(cy_stc_eeprom_context_t* context)
+{
+    uint32_t numRows;
+    uint32_t rowIndex;
+    uint64_t seqNum;
+    uint64_t seqNumMax;
+    uint32_t rowAddr;
+    uint32_t rowAddrMax;
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    uint32_t startTime = CY_EM_EEPROM_STATS_TIMESTAMP();
+
+    context->lastWrittenRowAddr = context->userNvmStartAddr;
+
+    if (0u == context->simpleMode)
+    {
+        CY_EM_EEPROM_STATS_ADD(lastRowRescans, 1u);
+        seqNumMax = 0u;
+        numRows = context->wearLevelingRows;
+        rowAddr = context->userNvmStartAddr;
+        rowAddrMax = rowAddr;
+
+        for (rowIndex = 0u; rowIndex < numRows; rowIndex++)
+        {
+            seqNum = ReadStoredSeqNum(rowAddr, context);
+            /* Is it a bigger number? */
+            if (seqNum > seqNumMax)
+            {
+                if (CY_EM_EEPROM_SUCCESS ==
+                    CheckRowChecksum(ReadRow(rowAddr, context), context->rowSize))
+                {
+                    seqNumMax = seqNum;
+                    rowAddrMax = rowAddr;
+                }
+            }
+            /* Switches to the next row */
+            rowAddr += context->rowSize;
+        }
+
+        /* Does the same search algorithm through the redundant copy if enabled */
+        if (0u != context->redundantCopy)
+        {
+            for (rowIndex = 0u; rowIndex < numRows; rowIndex++)
+            {
+                seqNum = ReadStoredSeqNum(rowAddr, context);
+                /* Is it a bigger number? */
+                if (seqNum > seqNumMax)
+                {
+                    if (CY_EM_EEPROM_SUCCESS ==
+                        CheckRowChecksum(ReadRow(rowAddr, context), context->rowSize))
+                    {
+                        seqNumMax = seqNum;
+                        /* The last written row is always tracked in the main copy, so the next
+                         * write continues the ring order.
+                         */
+                        rowAddrMax = rowAddr - (numRows * context->rowSize);
+                        result = CY_EM_EEPROM_REDUNDANT_COPY_USED;
+                    }
+                }
+                /* Switches to the next row */
+                rowAddr += context->rowSize;
+            }
+        }
+        context->lastWrittenRowAddr = rowAddrMax;
+        CY_EM_EEPROM_STATS_ADD_TIME(timeRescan, startTime);
+    }
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: CheckLastWrittenRowIntegrity
+****************************************************************************//**
+*
+* Checks the CRC of the last written row. If CRC is valid then the function
+* stores sequence number into the provided ptrSeqNum pointer. If CRC of the
+* last written row is invalid, then the function searches for the row with
+* the highest sequence number and valid CRC. In this case, the pointer to the
+* last written row is redefined inside context structure and the sequence
+* number of this row is returned.
+*
+* If the redundant copy is enabled, then the copy also considered at
+* the correct CRC verification and sequence number searching.
+*
+* If no row is written yet, the sequence number preceding the first row is
+* returned: the counter is zero and the layout id is the one of the context.
+*
+* If Simple Mode is enabled, the sequence number is not available and
+* this function returns 0.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \param ptrSeqNum
+* The pointer to the sequence number.
+*
+* \return
+* Returns the operation status. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t CheckLastWrittenRowIntegrity(
+    uint64_t* ptrSeqNum,
+    cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+
+    const uint32_t* ptrRow;
+    const uint32_t* ptrRowCopy;
+    uint64_t seqNum = 0u;
+
+    if (0u == context->simpleMode)
+    {
+        /* Checks the row CRC */
+        ptrRow = ReadRow(context->lastWrittenRowAddr, context);
+        if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, rowSize))
+        {
+            seqNum = GetStoredSeqNum(ptrRow);
+        }
+        else
+        {
+            /* CRC is bad. Checks if the redundant copy if enabled */
+            if (0u != context->redundantCopy)
+            {
+                /* Reads the redundant copy */
+                ptrRowCopy = ReadRedundantRow(context->lastWrittenRowAddr, context);
+
+                /* Checks CRC of the redundant copy */
+                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowCopy, rowSize))
+                {
+                    seqNum = GetStoredSeqNum(ptrRowCopy);
+                    result = CY_EM_EEPROM_REDUNDANT_COPY_USED;
+                }
+                else
+                {
+                    (void)DefineLastWrittenRow(context);
+                    ptrRow = ReadRow(context->lastWrittenRowAddr, context);
+                    if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, rowSize))
+                    {
+                        seqNum = GetStoredSeqNum(ptrRow);
+                    }
+                    result = CY_EM_EEPROM_BAD_CHECKSUM;
+                }
+            }
+            else
+            {
+                (void)DefineLastWrittenRow(context);
+                ptrRow = ReadRow(context->lastWrittenRowAddr, context);
+                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, rowSize))
+                {
+                    seqNum = GetStoredSeqNum(ptrRow);
+                }
+                result = CY_EM_EEPROM_BAD_CHECKSUM;
+            }
+        }
+
+        if (0u == seqNum)
+        {
+            /* No row is written yet, so the first row gets the layout id of the context */
+            seqNum = (uint64_t)context->layoutId << CY_EM_EEPROM_SEQ_NUM_LAYOUT_POS;
+        }
+    }
+    *ptrSeqNum = seqNum;
+
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: GetNextRowAddr
+****************************************************************************//**
+*
+* Increments the row address and performs out of the Em_EEPROM range verification.
+* The memory range is defined as the number of rows in the wear-leveling ring.
+* It does not include the redundant copy area.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the address of the next row.
+*
+*******************************************************************************/
+static uint32_t GetNextRowAddr(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    /* Gets the address of the next row to be processed without the range verification */
+    uint32_t lc_rowAddr = rowAddr + CY_EM_EEPROM_ROW_SIZE(context);
+
+    if (lc_rowAddr >= context->ringEndAddr)
+    {
+        lc_rowAddr = context->userNvmStartAddr;
+    }
+    return (lc_rowAddr);
+}
+
+
+/*******************************************************************************
+* Function Name: GetReadRowAddr
+****************************************************************************//**
+*
+* Calculates the row address to be used to read historic and headers data.
+* It is the row written numberOfRows writes before the specified row, which
+* holds the historic data of the same slot. If the ring is not longer than
+* numberOfRows, it is the specified row itself.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the address of the row where data is read from.
+*
+*******************************************************************************/
+static uint32_t GetReadRowAddr(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    return (GetPrevRowAddr(rowAddr, CY_EM_EEPROM_NUM_ROWS(context), context));
+}
+
+
+/*******************************************************************************
+* Function Name: GetPrevRowAddr
+****************************************************************************//**
+*
+* Steps the row address back by the specified number of rows within
+* the wear-leveling ring. It does not include the redundant copy area.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param numRowsBack
+* The number of rows to step back.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the address of the row written numRowsBack writes before rowAddr.
+*
+*******************************************************************************/
+static uint32_t GetPrevRowAddr(
+    uint32_t rowAddr,
+    uint32_t numRowsBack,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t ringRows = CY_EM_EEPROM_RING_ROWS(context);
+    uint32_t rowIndex = GetRowIndex(rowAddr, context);
+    /* The callers step back by one ring pass at most, so the remainder is rarely needed */
+    uint32_t stepBack = (numRowsBack < ringRows) ? numRowsBack : (numRowsBack % ringRows);
+
+    rowIndex = (rowIndex >= stepBack) ? (rowIndex - stepBack) : ((rowIndex + ringRows) - stepBack);
+
+    return (context->userNvmStartAddr + (rowIndex * CY_EM_EEPROM_ROW_SIZE(context)));
+}
+
+
+/*******************************************************************************
+* Function Name: GetRedundantRowAddr
+****************************************************************************//**
+*
+* Returns the address of the redundant copy of the specified row.
+*
+* \param rowAddr
+* The address of the nvm row in the wear-leveling ring.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the address of the row in the redundant copy area.
+*
+*******************************************************************************/
+static uint32_t GetRedundantRowAddr(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    return (rowAddr + context->redundantOffset);
+}
+
+
+/*******************************************************************************
+* Function Name: ReadRow
+****************************************************************************//**
+*
+* Returns the contents of the whole nvm row. The row is read through the block
+* device into the row read cache, so the storage does not need to be memory
+* mapped. A row already present in the cache is not read again within the same
+* Em_EEPROM operation. Otherwise, the least recently used cache entry is
+* replaced. The returned buffer is valid until the next call of this function.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the pointer to the row contents or NULL if the read operation failed.
+*
+*******************************************************************************/
+static const uint32_t* ReadRow(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
+    const uint32_t* ptrRow = NULL;
+    uint32_t i;
+    uint32_t entry = 0u;
+
+    for (i = 0u; i < CY_EM_EEPROM_ROW_CACHE_ENTRIES; i++)
+    {
+        if ((0u != rowCacheLastUse[i]) && (rowAddr == rowCacheAddr[i]))
+        {
+            ptrRow = &rowCacheData[i][0u];
+            entry = i;
+            break;
+        }
+        /* Tracks the least recently used entry, an empty entry is used first */
+        if (rowCacheLastUse[i] < rowCacheLastUse[entry])
+        {
+            entry = i;
+        }
+    }
+
+    if (NULL == ptrRow)
+    {
+        ptrRow = &rowCacheData[entry][0u];
+        rowCacheLastUse[entry] = 0u;
+
+        #if (CPUSS_FLASHC_ECT == 1)
+        if (WorkFlashRowIsErased(rowAddr, context))
+        {
+            /* An erased row is read as zeros */
+            (void)memset((void*)&rowCacheData[entry][0u], 0, rowSize);
+        }
+        else
+        #endif /* (CPUSS_FLASHC_ECT == 1) */
+        {
+            if (CY_RSLT_SUCCESS != BdRead(rowAddr, rowSize,
+                                          (uint8_t*)&rowCacheData[entry][0u], context))
+            {
+                ptrRow = NULL;
+            }
+        }
+    }
+
+    if (NULL != ptrRow)
+    {
+        rowCacheUseCount++;
+        rowCacheAddr[entry] = rowAddr;
+        rowCacheLastUse[entry] = rowCacheUseCount;
+    }
+    return (ptrRow);
+}
+
+
+/*******************************************************************************
+* Function Name: ReadRedundantRow
+****************************************************************************//**
+*
+* Returns the contents of the redundant copy of the specified row. It is used
+* when the row in the main copy has a bad checksum.
+*
+* \param rowAddr
+* The address of the nvm row in the wear-leveling ring.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the pointer to the row contents or NULL if the read operation failed.
+*
+*******************************************************************************/
+static const uint32_t* ReadRedundantRow(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    CY_EM_EEPROM_STATS_ADD(redundantCopyUsed, 1u);
+    return (ReadRow(GetRedundantRowAddr(rowAddr, context), context));
+}
+
+
+/*******************************************************************************
+* Function Name: ScrubRow
+****************************************************************************//**
+*
+* Verifies the checksum of a row of the wear-leveling ring and its redundant
+* copy if enabled. Rewrites a copy with a bad checksum from the good copy, or
+* the older copy from the newer one.
+*
+* \param rowAddr
+* The address of the nvm row in the wear-leveling ring.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the operation status. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t ScrubRow(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    const uint32_t* ptrRow;
+    uint32_t rowAddrCopy;
+    bool isRowValid;
+    bool isRowErased;
+    bool isCopyValid;
+    bool isRepaired = false;
+    uint64_t seqNum = 0u;
+    uint64_t seqNumCopy = 0u;
+
+    ptrRow = ReadRow(rowAddr, context);
+    isRowValid = (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, context->rowSize));
+    isRowErased = IsRowErased(ptrRow);
+
+    if (0u == context->redundantCopy)
+    {
+        if (!isRowValid && !isRowErased)
+        {
+            result = CY_EM_EEPROM_BAD_CHECKSUM;
+        }
+    }
+    else
+    {
+        /* Keeps the row in the RAM buffer as the cache may hold only one row */
+        if (isRowValid)
+        {
+            seqNum = GetStoredSeqNum(ptrRow);
+            (void)memcpy(&writeRamBuffer[0u], ptrRow, context->rowSize);
+        }
+
+        rowAddrCopy = GetRedundantRowAddr(rowAddr, context);
+        ptrRow = ReadRow(rowAddrCopy, context);
+        isCopyValid = (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, context->rowSize));
+        if (isCopyValid)
+        {
+            seqNumCopy = GetStoredSeqNum(ptrRow);
+        }
+
+        if (isRowValid && ((!isCopyValid) || (seqNum > seqNumCopy)))
+        {
+            result = WriteRow(rowAddrCopy, &writeRamBuffer[0u], context);
+            isRepaired = true;
+        }
+        else if (isCopyValid && ((!isRowValid) || (seqNumCopy > seqNum)))
+        {
+            (void)memcpy(&writeRamBuffer[0u], ptrRow, context->rowSize);
+            result = WriteRow(rowAddr, &writeRamBuffer[0u], context);
+            isRepaired = true;
+        }
+        else if (!isRowValid && !isCopyValid && !(isRowErased && IsRowErased(ptrRow)))
+        {
+            result = CY_EM_EEPROM_BAD_CHECKSUM;
+        }
+        else
+        {
+            /* Both copies are good and hold the same write, or both are erased */
+        }
+
+        if (isRepaired && (CY_EM_EEPROM_SUCCESS == result))
+        {
+            CY_EM_EEPROM_STATS_ADD(rowsRepaired, 1u);
+            result = CY_EM_EEPROM_REDUNDANT_COPY_USED;
+        }
+    }
+
+    return (result);
+}
+
+
+/*******************************************************************************
+* Function Name: StartOperation
+****************************************************************************//**
+*
+* Prepares the global state for an Em_EEPROM operation on the specified
+* context. It is called at the start of each Em_EEPROM function that accesses
+* the storage.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+*******************************************************************************/
+static void StartOperation(cy_stc_eeprom_context_t* context)
+{
+    InvalidateRowCache();
+    #if (CY_EM_EEPROM_STATS_ENABLE == 1u)
+    activeStats = &context->stats;
+    #else
+    (void)context;
+    #endif /* (CY_EM_EEPROM_STATS_ENABLE == 1u) */
+}
+
+
+/*******************************************************************************
+* Function Name: InvalidateRowCache
+****************************************************************************//**
+*
+* Empties the row read cache. It is called at the start of each Em_EEPROM
+* operation, as the storage may be changed between the operations or belong
+* to another Em_EEPROM instance.
+*
+*******************************************************************************/
+static void InvalidateRowCache(void)
+{
+    (void)memset((void*)&rowCacheLastUse[0u], 0, sizeof(rowCacheLastUse));
+    rowCacheUseCount = 0u;
+    #if (CPUSS_FLASHC_ECT == 1)
+    (void)memset((void*)&rowState[0u], (int)CY_EM_EEPROM_ROW_STATE_UNKNOWN, sizeof(rowState));
+    #endif /* (CPUSS_FLASHC_ECT == 1) */
+}
+
+
+/*******************************************************************************
+* Function Name: InvalidateCachedRow
+****************************************************************************//**
+*
+* Removes the specified row from the row read cache. It is called before
+* the row is written or erased.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+*******************************************************************************/
+static void InvalidateCachedRow(uint32_t rowAddr)
+{
+    uint32_t i;
+
+    for (i = 0u; i < CY_EM_EEPROM_ROW_CACHE_ENTRIES; i++)
+    {
+        if (rowAddr == rowCacheAddr[i])
+        {
+            rowCacheLastUse[i] = 0u;
+        }
+    }
+    #if (CPUSS_FLASHC_ECT == 1)
+    for (i = 0u; i < CY_EM_EEPROM_ROW_STATE_ENTRIES; i++)
+    {
+        if (rowAddr == rowStateAddr[i])
+        {
+            rowState[i] = CY_EM_EEPROM_ROW_STATE_UNKNOWN;
+        }
+    }
+    #endif /* (CPUSS_FLASHC_ECT == 1) */
+}
+
+
+/*******************************************************************************
+* Function Name: ReadStoredSeqNum
+****************************************************************************//**
+*
+* Reads only the checksum and sequence number words of the specified row
+* through the block device and returns the stored sequence number. It is used
+* to scan the rows without reading their data.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The stored sequence number or 0 if the read operation failed.
+*
+*******************************************************************************/
+static uint64_t ReadStoredSeqNum(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowHeader[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32] = { 0u, 0u };
+
+    #if (CPUSS_FLASHC_ECT == 1)
+    bool isHeaderErased = true;
+    uint32_t index = GetRowIndex(rowAddr, context) % CY_EM_EEPROM_ROW_STATE_ENTRIES;
+
+    if ((rowAddr == rowStateAddr[index]) && (CY_EM_EEPROM_ROW_STATE_UNKNOWN != rowState[index]))
+    {
+        isHeaderErased = (CY_EM_EEPROM_ROW_STATE_BLANK == rowState[index]);
+    }
+    else if (!WorkFlashIsErased(rowAddr, sizeof(rowHeader)))
+    {
+        /* The row with a programmed header is not blank, so ReadRow() does not check it again */
+        SetRowState(rowAddr, CY_EM_EEPROM_ROW_STATE_WRITTEN, context);
+        isHeaderErased = false;
+    }
+    else
+    {
+        /* Keeps the row state unknown as only the header is checked */
+    }
+    if (!isHeaderErased)
+    #endif /* (CPUSS_FLASHC_ECT == 1) */
+    {
+        if (CY_RSLT_SUCCESS != BdRead(rowAddr, sizeof(rowHeader), (uint8_t*)&rowHeader[0u],
+                                      context))
+        {
+            (void)memset((void*)&rowHeader[0u], 0, sizeof(rowHeader));
+        }
+    }
+    return (GetStoredSeqNum(&rowHeader[0u]));
+}
+
+
+/*******************************************************************************
+* Function Name: IsRowErased
+****************************************************************************//**
+*
+* Checks if the row has never been written. Such a row has the sequence number
+* and the checksum equal to zero, or all ones on the nvm that erases to ones.
+*
+* \param ptrRow
+* The pointer to a row. NULL is treated as a row that was written.
+*
+* \return
+* Returns true if the row has never been written.
+*
+*******************************************************************************/
+static bool IsRowErased(const uint32_t* ptrRow)
+{
+    return ((NULL != ptrRow) &&
+            (((0u == GetStoredSeqNum(ptrRow)) && (0u == GetStoredRowChecksum(ptrRow))) ||
+             ((0xFFFFFFFFu == ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32]) &&
+              (0xFFFFFFFFu == ptrRow[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32]))));
+}
+
+
+/*******************************************************************************
+* Function Name: GetRowWriteCount
+****************************************************************************//**
+*
+* Returns the number of times the specified row of the wear-leveling ring was
+* written. Rows are written in the ring order, so the row which is d rows
+* before the last written row was written last with the sequence number
+* seqNum - d, and before that once per ring pass.
+*
+* \param rowIndex
+* The index of the row in the wear-leveling ring.
+*
+* \param seqNum
+* The sequence number of the last written row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The number of writes of the row.
+*
+*******************************************************************************/
+static uint32_t GetRowWriteCount(
+    uint32_t rowIndex,
+    uint64_t seqNum,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t ringRows = context->wearLevelingRows;
+    uint32_t lastIndex = GetRowIndex(context->lastWrittenRowAddr, context);
+    uint32_t distance = ((lastIndex + ringRows) - rowIndex) % ringRows;
+    uint32_t writeCount = 0u;
+    uint64_t numWrites = seqNum & CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK;
+
+    if (numWrites > distance)
+    {
+        writeCount = (uint32_t)(((numWrites - distance - 1u) / ringRows) + 1u);
+    }
+    return (writeCount);
+}
+
+
+/*******************************************************************************
+* Function Name: GetHistoricSlot
+****************************************************************************//**
+*
+* Returns the index of the Em_EEPROM row (slot) which historic data is stored
+* in the specified row.
+*
+* When the wear-leveling ring is a whole multiple of numberOfRows, the slot is
+* defined by the row position in the ring. Otherwise, the slot is defined by
+* the sequence number, as rows are always written in the ring order.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param seqNum
+* The sequence number of the row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The slot index from 0 to numberOfRows - 1.
+*
+*******************************************************************************/
+static uint32_t GetHistoricSlot(
+    uint32_t rowAddr,
+    uint64_t seqNum,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t numRows = CY_EM_EEPROM_NUM_ROWS(context);
+    uint32_t numRowsShift = CY_EM_EEPROM_NUM_ROWS_SHIFT(context);
+    uint32_t slot;
+
+    if (CY_EM_EEPROM_RING_MULTIPLE(context))
+    {
+        slot = RemainderFast(GetRowIndex(rowAddr, context), numRows, numRowsShift);
+    }
+    else if (0u != numRowsShift)
+    {
+        slot = (uint32_t)seqNum & (numRows - 1u);
+    }
+    else
+    {
+        slot = (uint32_t)(seqNum % numRows);
+    }
+    return (slot);
+}
+
+
+/*******************************************************************************
+* Function Name: GetLayoutId
+****************************************************************************//**
+*
+* Returns the id of the layout of the Em_EEPROM in the nvm, a hash of
+* the parameters which define the row contents and their placement relative
+* to userNvmStartAddr. The id is odd, so it is never zero, the id of the rows
+* of the layouts that were never migrated. It is also below
+* CY_EM_EEPROM_LAYOUT_ID_MASK, so the upper bits of the sequence number are
+* never all ones as in a row erased to ones.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The odd layout id from 1 to CY_EM_EEPROM_LAYOUT_ID_MASK - 2.
+*
+*******************************************************************************/
+static uint32_t GetLayoutId(const cy_stc_eeprom_context_t* context)
+{
+    uint32_t layout[4u];
+    uint32_t hash = CY_EM_EEPROM_LAYOUT_HASH_BASIS;
+    uint32_t i;
+
+    layout[0u] = context->eepromSize;
+    layout[1u] = context->wearLevelingRows;
+    layout[2u] = (0u != context->redundantCopy) ? 1u : 0u;
+    layout[3u] = context->rowSize;
+
+    /* FNV-1a over the bytes of the layout parameters */
+    for (i = 0u; i < (sizeof(layout) * 8u); i += 8u)
+    {
+        hash = (hash ^ ((layout[i / 32u] >> (i % 32u)) & 0xFFu)) * CY_EM_EEPROM_LAYOUT_HASH_PRIME;
+    }
+    hash = ((hash ^ (hash >> 16u)) & CY_EM_EEPROM_LAYOUT_ID_MASK) | 1u;
+
+    return ((CY_EM_EEPROM_LAYOUT_ID_MASK == hash) ? (hash - 2u) : hash);
+}
+
+
+/*******************************************************************************
+* Function Name: GetLayoutEndAddr
+****************************************************************************//**
+*
+* Returns the address after the last row of the Em_EEPROM, including
+* the redundant copy if enabled.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The address after the last row.
+*
+*******************************************************************************/
+static uint32_t GetLayoutEndAddr(const cy_stc_eeprom_context_t* context)
+{
+    return (context->ringEndAddr +
+            ((0u != context->redundantCopy) ? context->redundantOffset : 0u));
+}
+
+
+/*******************************************************************************
+* Function Name: IsInLayout
+****************************************************************************//**
+*
+* Checks if the row is one of the rows of the Em_EEPROM, including
+* the redundant copy if enabled.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* true if the row belongs to the Em_EEPROM.
+*
+*******************************************************************************/
+static bool IsInLayout(uint32_t rowAddr, const cy_stc_eeprom_context_t* context)
+{
+    return ((rowAddr >= context->userNvmStartAddr) && (rowAddr < GetLayoutEndAddr(context)));
+}
+
+
+/*******************************************************************************
+* Function Name: GetRingRowAddr
+****************************************************************************//**
+*
+* Returns the address of the row in the wear-leveling ring for a row of
+* the redundant copy, or the address itself for a row of the ring.
+*
+* \param rowAddr
+* The address of the nvm row of the Em_EEPROM.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The address of the row in the wear-leveling ring.
+*
+*******************************************************************************/
+static uint32_t GetRingRowAddr(uint32_t rowAddr, const cy_stc_eeprom_context_t* context)
+{
+    return ((rowAddr < context->ringEndAddr) ? rowAddr : (rowAddr - context->redundantOffset));
+}
+
+
+/*******************************************************************************
+* Function Name: IsInWindow
+****************************************************************************//**
+*
+* Checks if the row or its redundant copy is one of the specified number of
+* consecutive rows of the wear-leveling ring.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param firstRowAddr
+* The address of the first row of the window in the wear-leveling ring.
+*
+* \param numRows
+* The number of rows in the window.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* true if the row is in the window.
+*
+*******************************************************************************/
+static bool IsInWindow(
+    uint32_t rowAddr,
+    uint32_t firstRowAddr,
+    uint32_t numRows,
+    const cy_stc_eeprom_context_t* context)
+{
+    bool inWindow = false;
+    uint32_t ringRows = context->wearLevelingRows;
+    uint32_t rowIndex;
+    uint32_t firstIndex;
+
+    if (IsInLayout(rowAddr, context))
+    {
+        rowIndex = GetRowIndex(GetRingRowAddr(rowAddr, context), context);
+        firstIndex = GetRowIndex(firstRowAddr, context);
+        inWindow = ((((rowIndex + ringRows) - firstIndex) % ringRows) < numRows);
+    }
+    return (inWindow);
+}
+
+
+/*******************************************************************************
+* Function Name: ReadValidSeqNum
+****************************************************************************//**
+*
+* Returns the sequence number of the row if its checksum is valid. The whole
+* row is read only if the sequence number is not zero.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The sequence number of the row, or zero for an erased or damaged row.
+*
+*******************************************************************************/
+static uint64_t ReadValidSeqNum(uint32_t rowAddr, const cy_stc_eeprom_context_t* context)
+{
+    uint64_t seqNum = ReadStoredSeqNum(rowAddr, context);
+
+    if ((0u != seqNum) &&
+        (CY_EM_EEPROM_SUCCESS != CheckRowChecksum(ReadRow(rowAddr, context), context->rowSize)))
+    {
+        seqNum = 0u;
+    }
+    return (seqNum);
+}
+
+
+/*******************************************************************************
+* Function Name: CopyHistoricData
+****************************************************************************//**
+*
+* Copies relevant historic data into the specified buffer.
+*
+* The function includes the proper handling of the redundant copy and wear leveling
+* if enabled.
+*
+* \param ptrRowWrite
+* The pointer to the buffer to store historic data.
+*
+* \param rowAddr
+* The address of the current active nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns the operation status. See cy_en_em_eeprom_status_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t CopyHistoricData(
+    uint32_t* ptrRowWrite,
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
+    uint32_t byteInRow = CY_EM_EEPROM_BYTE_IN_ROW(context);
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_CHECKSUM;
+    uint32_t historicDataOffsetU32 = ((rowSize /4) /2);
+    uint32_t rowAddrRead = GetReadRowAddr(rowAddr, context);
+    const uint32_t* ptrRowRead = ReadRow(rowAddrRead, context);
+
+    if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowRead, rowSize))
+    {
+        (void)memcpy((void*)&ptrRowWrite[historicDataOffsetU32],
+                     (const void*)&ptrRowRead[historicDataOffsetU32], byteInRow);
+        result = CY_EM_EEPROM_SUCCESS;
+    }
+    else
+    {
+        /* CRC is bad. Checks if the redundant copy if enabled */
+        if (0u != context->redundantCopy)
+        {
+            ptrRowRead = ReadRedundantRow(rowAddrRead, context);
+            if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowRead, rowSize))
+            {
+                /* Copies the Em_EEPROM historic data from the redundant copy */
+                (void)memcpy((void*)&ptrRowWrite[historicDataOffsetU32],
+                             (const void*)&ptrRowRead[historicDataOffsetU32], byteInRow);
+                /* Reports that the redundant copy was used */
+                result = CY_EM_EEPROM_REDUNDANT_COPY_USED;
+            }
+        }
+        if (IsRowErased(ptrRowRead))
+        {
+            /*
+             * Considers a row with a bad checksum as the row that never has never been
+             * written before if the sequence number and CRC values are the erased value.
+             * In this case, reports zeros and does not
+             * report the failed status of the write operation.
+             */
+            result = CY_EM_EEPROM_SUCCESS;
+        }
+    }
+    return result;
+}
+
+
+/*******************************************************************************
+* Function Name: CopyHeadersData
+****************************************************************************//**
+*
+* Copies relevant data located in the headers into a row specified by the
+* address rowAddr.
+* The function includes the proper handling of a redundant copy and wear leveling
+* if enabled.
+*
+* \param ptrRowWrite
+* The pointer to the buffer where to store the headers data.
+*
+* \param rowAddr
+* The address of the current active nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t CopyHeadersData(
+    uint32_t* ptrRowWrite,
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    uint32_t rowSize = CY_EM_EEPROM_ROW_SIZE(context);
+    uint32_t byteInRow = CY_EM_EEPROM_BYTE_IN_ROW(context);
+    uint32_t numRows = CY_EM_EEPROM_NUM_ROWS(context);
+    uint32_t i;
+    uint32_t strHistAddr;
+    uint32_t endHistAddr;
+    uint32_t strHeadAddr;
+    uint32_t endHeadAddr;
+    uint32_t dstOffset;
+    uint32_t srcOffset;
+    uint32_t sizeToCopy;
+    cy_en_em_eeprom_status_t crcStatus = CY_EM_EEPROM_SUCCESS;
+    uint32_t numReads = numRows;
+    uint8_t* ptrHistoricData = &((uint8_t*)ptrRowWrite)[byteInRow];
+    const uint32_t* ptrRowWork;
+    uint32_t rowAddrRead;
+    uint64_t seqNum = GetStoredSeqNum(ptrRowWrite);
+
+    /* Skips unwritten rows if any */
+    if (numReads > (seqNum & CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK))
+    {
+        /* Only the first N rows have been written so far */
+        numReads = (uint32_t)(seqNum & CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK);
+    }
+
+    if (numRows <= 0U)
+    {
+        crcStatus = CY_EM_EEPROM_WRITE_FAIL;
+    }
+
+    if (crcStatus == CY_EM_EEPROM_SUCCESS)
+    {
+        /* Starts with the oldest row which headers are still active. The row about to write
+           is replaced by the recently created header. */
+        rowAddrRead = GetPrevRowAddr(rowAddr, numReads - 1u, context);
+
+        /* The address within the Em_EEPROM storage of historic data of the specified by the rowAddr
+           row */
+        strHistAddr = GetHistoricSlot(rowAddr, seqNum, context) * byteInRow;
+        endHistAddr = strHistAddr + byteInRow;
+
+        for (i = 0u; i < numReads; i++)
+        {
+            /* For the last header-read operation, checks data in the recently created header */
+            if (i >= (numReads - 1u))
+            {
+                ptrRowWork = ptrRowWrite;
+                crcStatus = CY_EM_EEPROM_SUCCESS;
+            }
+            else
+            {
+                ptrRowWork = ReadRow(rowAddrRead, context);
+                /* Checks CRC of the row to be read except the last row of a recently created header
+                 */
+                crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+                if ((CY_EM_EEPROM_SUCCESS != crcStatus) && (0u != context->redundantCopy))
+                {
+                    /* Reads the redundant copy */
+                    ptrRowWork = ReadRedundantRow(rowAddrRead, context);
+                    crcStatus = CheckRowChecksum(ptrRowWork, rowSize);
+                }
+            }
+
+            /* Skips the row if CRC is bad */
+            if (CY_EM_EEPROM_SUCCESS == crcStatus)
+            {
+                /* The address of header data */
+                strHeadAddr = ptrRowWork[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32];
+                endHeadAddr = strHeadAddr + (ptrRowWork[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] &
+                                             CY_EM_EEPROM_HEADER_LEN_MASK);
+
+                /* Skips the row if the header data address is out of the historic data address
+                   range */
+                if ((strHeadAddr < endHistAddr) && (endHeadAddr > strHistAddr))
+                {
+                    /* A compressed header may span more than two historic data slots */
+                    dstOffset = (strHeadAddr > strHistAddr) ? (strHeadAddr - strHistAddr) : (0u);
+                    srcOffset = (strHeadAddr > strHistAddr) ? (0u) : (strHistAddr - strHeadAddr);
+                    sizeToCopy = (strHeadAddr > strHistAddr) ? (strHeadAddr) : (strHistAddr);
+                    sizeToCopy = ((endHeadAddr < endHistAddr) ? endHeadAddr : endHistAddr) -
+                                 sizeToCopy;
+
+                    GetHeaderData(ptrRowWork, srcOffset, &ptrHistoricData[dstOffset], sizeToCopy,
+                                  context);
+                }
+            }
+            rowAddrRead = GetNextRowAddr(rowAddrRead, context);
+        }
+        crcStatus = CY_EM_EEPROM_SUCCESS;
+    }
+    return (crcStatus);
+}
+
+
+/*******************************************************************************
+* Function Name: GetPhysicalSize
+****************************************************************************//**
+*
+* Returns the size of nvm allocated for Em_EEPROM including wear leveling
+* and a redundant copy overhead
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \param config
+* The pointer to the configuration structure.
+*
+*******************************************************************************/
+static uint32_t GetPhysicalSize(
+    const cy_stc_eeprom_context_t* context,
+    const cy_stc_eeprom_config2_t* config)
+{
+    /** Defines the size of nvm without wear leveling and redundant copy overhead */
+    uint32_t num_data = context->numberOfRows * (context->rowSize);
+
+    uint32_t size;
+
+    if (0u != config->simpleMode)
+    {
+        size = num_data;
+    }
+    else if (0u == config->wearLevelingFactor)
+    {
+        size = (config->wearLevelingRows * context->rowSize) * ((config->redundantCopy) + 1uL);
+    }
+    else
+    {
+        size = (num_data * config->wearLevelingFactor) * ((config->redundantCopy) + 1uL);
+    }
+
+    return size;
+}
+
+
+/*******************************************************************************
+* Function Name: ComputeEEPROMProgramSize
+****************************************************************************//**
+*
+* Makes sure that the program size in EEPROM context is an integer multiple of actual
+* program size coming from the block storage API whenever the actual program size
+* is smaller than the minimum EEPROM ROW SIZE in extended mode. In SimpleMode we have
+* no need for a minimum EEPROM ROW SIZE so we can use the actualProgramSize returned
+* by the block device.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+*******************************************************************************/
+static void ComputeEEPROMProgramSize(cy_stc_eeprom_context_t* context)
+{
+    uint32_t actualProgramSize =
+        ((uint32_t)context->bd->get_program_size(context->bd->context, context->userNvmStartAddr));
+    if ((actualProgramSize < CY_EM_EEPROM_MINIMUM_ROW_SIZE) && (context->simpleMode == 0))
+    {
+        context->rowSize = (((CY_EM_EEPROM_MINIMUM_ROW_SIZE - 1) / actualProgramSize) + 1) *
+                           actualProgramSize;
+    }
+    else
+    {
+        context->rowSize = actualProgramSize;
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ComputeGeometry
+****************************************************************************//**
+*
+* Stores the geometry derived from the configuration in the context, so
+* the row lookups do not compute it on each call and use shifts and masks
+* instead of divisions where possible.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+*******************************************************************************/
+static void ComputeGeometry(cy_stc_eeprom_context_t* context)
+{
+    context->redundantOffset = context->wearLevelingRows * context->rowSize;
+    context->ringEndAddr = context->userNvmStartAddr + context->redundantOffset;
+    context->rowSizeShift = GetPowerOfTwoShift(context->rowSize);
+    context->byteInRowShift = GetPowerOfTwoShift(context->byteInRow);
+    context->numberOfRowsShift = GetPowerOfTwoShift(context->numberOfRows);
+    context->ringMultipleOfRows =
+        (0u == (context->wearLevelingRows % context->numberOfRows)) ? 1u : 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: GetPowerOfTwoShift
+****************************************************************************//**
+*
+* Returns log2 of the value if it is a power of two greater than one.
+*
+* \param value
+* The value.
+*
+* \return
+* log2 of the value or zero if the value is not a power of two or is one.
+*
+*******************************************************************************/
+static uint8_t GetPowerOfTwoShift(uint32_t value)
+{
+    uint8_t shift = 0u;
+
+    if ((1u < value) && (0u == (value & (value - 1u))))
+    {
+        while ((1uL << shift) != value)
+        {
+            shift++;
+        }
+    }
+    return (shift);
+}
+
+
+/*******************************************************************************
+* Function Name: DivideFast
+****************************************************************************//**
+*
+* Divides the value by the divisor with a shift if the divisor is a power of
+* two. It avoids the software division on devices without a hardware divider.
+*
+* \param value
+* The dividend.
+*
+* \param divisor
+* The divisor.
+*
+* \param shift
+* log2 of the divisor or zero if the divisor is not a power of two.
+*
+* \return
+* The quotient.
+*
+*******************************************************************************/
+static uint32_t DivideFast(
+    uint32_t value,
+    uint32_t divisor,
+    uint32_t shift)
+{
+    return ((0u != shift) ? (value >> shift) : (value / divisor));
+}
+
+
+/*******************************************************************************
+* Function Name: RemainderFast
+****************************************************************************//**
+*
+* Returns the remainder of the division of the value by the divisor with
+* a mask if the divisor is a power of two.
+*
+* \param value
+* The dividend.
+*
+* \param divisor
+* The divisor.
+*
+* \param shift
+* log2 of the divisor or zero if the divisor is not a power of two.
+*
+* \return
+* The remainder.
+*
+*******************************************************************************/
+static uint32_t RemainderFast(
+    uint32_t value,
+    uint32_t divisor,
+    uint32_t shift)
+{
+    return ((0u != shift) ? (value & (divisor - 1u)) : (value % divisor));
+}
+
+
+/*******************************************************************************
+* Function Name: GetRowIndex
+****************************************************************************//**
+*
+* Returns the index of the row in the nvm area of the Em_EEPROM.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* The index of the row from userNvmStartAddr.
+*
+*******************************************************************************/
+static uint32_t GetRowIndex(
+    uint32_t rowAddr,
+    const cy_stc_eeprom_context_t* context)
+{
+    return (DivideFast(rowAddr - context->userNvmStartAddr, CY_EM_EEPROM_ROW_SIZE(context),
+                       CY_EM_EEPROM_ROW_SIZE_SHIFT(context)));
+}
+
+
+/*******************************************************************************
+* Function Name: GetHeaderData
+****************************************************************************//**
+*
+* Copies a part of the header data of a row. The compressed header data is
+* expanded.
+*
+* \param ptrRow
+* The pointer to the row contents.
+*
+* \param offset
+* The offset of the part in the header data.
+*
+* \param data
+* The pointer to the buffer to copy the part to.
+*
+* \param size
+* The size of the part in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+*******************************************************************************/
+static void GetHeaderData(
+    const uint32_t* ptrRow,
+    uint32_t offset,
+    uint8_t* data,
+    uint32_t size,
+    const cy_stc_eeprom_context_t* context)
+{
+    const uint8_t* ptrHeaderData =
+        &((const uint8_t*)ptrRow)[CY_EM_EEPROM_HEADER_DATA_OFFSET];
+
+    if (0u != (ptrRow[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32] & CY_EM_EEPROM_HEADER_LEN_COMPRESSED))
+    {
+        ExpandHeaderData(ptrHeaderData, context->headerDataLength, offset, data, size);
+    }
+    else
+    {
+        (void)memcpy(data, &ptrHeaderData[offset], size);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ExpandHeaderData
+****************************************************************************//**
+*
+* Expands a part of the run-length encoded header data. Each block of
+* the encoded data starts with a control byte. The control byte below
+* CY_EM_EEPROM_RLE_RUN_FLAG is followed by (control byte + 1) literal bytes.
+* Otherwise, the next byte is repeated (control byte -
+* CY_EM_EEPROM_RLE_RUN_BIAS) times. Only the requested part is written, so no
+* intermediate buffer is needed.
+*
+* \param packedData
+* The pointer to the encoded data.
+*
+* \param packedSize
+* The size of the encoded data area in bytes.
+*
+* \param offset
+* The offset of the part in the expanded data.
+*
+* \param data
+* The pointer to the buffer to write the part to.
+*
+* \param size
+* The size of the part in bytes.
+*
+*******************************************************************************/
+static void ExpandHeaderData(
+    const uint8_t* packedData,
+    uint32_t packedSize,
+    uint32_t offset,
+    uint8_t* data,
+    uint32_t size)
+{
+    uint32_t packedPos = 0u;
+    uint32_t pos = 0u;
+    uint32_t blockSize;
+    uint32_t strCopy;
+    uint32_t endCopy;
+    bool isRun;
+
+    while ((pos < (offset + size)) && ((packedPos + 1u) < packedSize))
+    {
+        isRun = (packedData[packedPos] >= CY_EM_EEPROM_RLE_RUN_FLAG);
+        blockSize = isRun ? ((uint32_t)packedData[packedPos] - CY_EM_EEPROM_RLE_RUN_BIAS) :
+                    ((uint32_t)packedData[packedPos] + 1u);
+        packedPos++;
+        if ((!isRun) && (blockSize > (packedSize - packedPos)))
+        {
+            /* Does not read past the header data area */
+            blockSize = packedSize - packedPos;
+        }
+
+        /* Writes the overlap of the block and the requested part */
+        strCopy = (pos > offset) ? pos : offset;
+        endCopy = ((pos + blockSize) < (offset + size)) ? (pos + blockSize) : (offset + size);
+        if (strCopy < endCopy)
+        {
+            if (isRun)
+            {
+                (void)memset(&data[strCopy - offset], (int)packedData[packedPos],
+                             endCopy - strCopy);
+            }
+            else
+            {
+                (void)memcpy(&data[strCopy - offset], &packedData[packedPos + (strCopy - pos)],
+                             endCopy - strCopy);
+            }
+        }
+
+        pos += blockSize;
+        packedPos += isRun ? 1u : blockSize;
+    }
+}
+
+
+#if (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u)
+/*******************************************************************************
+* Function Name: CompressHeaderData
+****************************************************************************//**
+*
+* Run-length encodes the start of the data into the header data area. The
+* encoding stops when the area is full. See ExpandHeaderData() for the format.
+*
+* \param data
+* The pointer to the data to encode.
+*
+* \param size
+* The size of the data in bytes.
+*
+* \param packedData
+* The pointer to the header data area.
+*
+* \param packedSize
+* The size of the header data area in bytes.
+*
+* \return
+* The number of the data bytes encoded.
+*
+*******************************************************************************/
+static uint32_t CompressHeaderData(
+    const uint8_t* data,
+    uint32_t size,
+    uint8_t* packedData,
+    uint32_t packedSize)
+{
+    uint32_t pos = 0u;
+    uint32_t packedPos = 0u;
+    uint32_t blockSize;
+    bool isFull = false;
+
+    while ((!isFull) && (pos < size))
+    {
+        blockSize = GetRunLength(&data[pos], size - pos);
+        if (blockSize >= CY_EM_EEPROM_RLE_MIN_RUN)
+        {
+            isFull = ((packedPos + 2u) > packedSize);
+            if (!isFull)
+            {
+                packedData[packedPos] = (uint8_t)(blockSize + CY_EM_EEPROM_RLE_RUN_BIAS);
+                packedData[packedPos + 1u] = data[pos];
+                packedPos += 2u;
+                pos += blockSize;
+            }
+        }
+        else
+        {
+            /* Extends the literal block up to the next run */
+            blockSize = 1u;
+            while (((pos + blockSize) < size) && (blockSize < CY_EM_EEPROM_RLE_MAX_LITERAL) &&
+                   (GetRunLength(&data[pos + blockSize], size - (pos + blockSize)) <
+                    CY_EM_EEPROM_RLE_MIN_RUN))
+            {
+                blockSize++;
+            }
+
+            isFull = ((packedPos + 2u) > packedSize);
+            if (!isFull)
+            {
+                if (blockSize > (packedSize - (packedPos + 1u)))
+                {
+                    blockSize = packedSize - (packedPos + 1u);
+                }
+                packedData[packedPos] = (uint8_t)(blockSize - 1u);
+                (void)memcpy(&packedData[packedPos + 1u], &data[pos], blockSize);
+                packedPos += blockSize + 1u;
+                pos += blockSize;
+            }
+        }
+    }
+    return pos;
+}
+
+
+/*******************************************************************************
+* Function Name: GetRunLength
+****************************************************************************//**
+*
+* Returns the number of repeated bytes at the start of the data up to
+* CY_EM_EEPROM_RLE_MAX_RUN.
+*
+* \param data
+* The pointer to the data.
+*
+* \param size
+* The size of the data in bytes, at least 1.
+*
+* \return
+* The number of repeated bytes.
+*
+*******************************************************************************/
+static uint32_t GetRunLength(const uint8_t* data, uint32_t size)
+{
+    uint32_t runLength = 1u;
+
+    while ((runLength < size) && (runLength < CY_EM_EEPROM_RLE_MAX_RUN) &&
+           (data[runLength] == data[0u]))
+    {
+        runLength++;
+    }
+    return runLength;
+}
+
+
+#endif /* (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u) */
+
+/*******************************************************************************
+* Function Name: FindRegion
+****************************************************************************//**
+*
+* Finds the region holding the logical address.
+*
+* \param addr
+* The logical address.
+*
+* \param size
+* The number of bytes remaining to access from the address.
+*
+* \param regions
+* The array of the regions.
+*
+* \param numRegions
+* The number of the regions in the array.
+*
+* \param partSize
+* The number of bytes of the access within the region. Zero if no region is
+* found.
+*
+* \return
+* The pointer to the region or NULL if no region with a context holds
+* the address.
+*
+*******************************************************************************/
+static const cy_stc_em_eeprom_region_t* FindRegion(
+    uint32_t addr,
+    uint32_t size,
+    const cy_stc_em_eeprom_region_t* regions,
+    uint32_t numRegions,
+    uint32_t* partSize)
+{
+    const cy_stc_em_eeprom_region_t* region = NULL;
+    uint32_t i;
+
+    *partSize = 0u;
+    for (i = 0u; (i < numRegions) && (NULL == region); i++)
+    {
+        if ((NULL != regions[i].context) && (addr >= regions[i].addr) &&
+            ((addr - regions[i].addr) < regions[i].size))
+        {
+            region = &regions[i];
+            *partSize = region->size - (addr - region->addr);
+            *partSize = (*partSize < size) ? *partSize : size;
+        }
+    }
+    return (region);
 }
 
 
 /*******************************************************************************
-* Function Name: EraseRow
+* Function Name: MergeRegionStatus
 ****************************************************************************//**
 *
-* Erases one nvm row starting from the specified row address. If the redundant
-* copy option is enabled, the corresponding row in the redundant copy will also
-* be erased.
-*
-* \param rowAddr
-* The pointer of the nvm row.
-*
-*
-* \param ramBuffAddr
-* The address of the RAM buffer that contains zeroed data.
-* Reserved for compatibility.
+* Combines the status of an access to a region with the status of
+* the preceding regions in the following order:
+* The highest priority: any error other than CY_EM_EEPROM_BAD_CHECKSUM
+*                       CY_EM_EEPROM_BAD_CHECKSUM
+*                       CY_EM_EEPROM_REDUNDANT_COPY_USED
+* The lowest priority:  CY_EM_EEPROM_SUCCESS
 *
+* \param result
+* The status of the preceding regions.
 *
-* \param context
-* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+* \param partResult
+* The status of the region.
 *
 * \return
-* Returns the status of operation. See cy_en_em_eeprom_status_t.
+* The combined status.
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t EraseRow(
-    const uint32_t* rowAddr,
-    const uint32_t* ramBuffAddr,
-    const cy_stc_eeprom_context_t* context)
+static cy_en_em_eeprom_status_t MergeRegionStatus(
+    cy_en_em_eeprom_status_t result,
+    cy_en_em_eeprom_status_t partResult)
 {
-    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_WRITE_FAIL;
-    cy_rslt_t eraseResult = CY_RSLT_SUCCESS;
-    bool isEraseRequired = context->bd->is_erase_required;
+    cy_en_em_eeprom_status_t status = result;
 
-    if (0u != context->blockingWrite)
-    {
-        if (isEraseRequired)
-        {
-            eraseResult = context->bd->erase(context->bd->context,
-                                             ((uint32_t)rowAddr),
-                                             context->rowSize);
-        }
-        if (eraseResult == CY_RSLT_SUCCESS)
-        {
-            eraseResult = context->bd->program(context->bd->context,
-                                               ((uint32_t)rowAddr),
-                                               context->rowSize,
-                                               (uint8_t*)ramBuffAddr);
-        }
-    }
-    #if defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED)
-    else
+    if ((CY_EM_EEPROM_SUCCESS == result) ||
+        ((CY_EM_EEPROM_REDUNDANT_COPY_USED == result) && (CY_EM_EEPROM_SUCCESS != partResult)) ||
+        ((CY_EM_EEPROM_BAD_CHECKSUM == result) && (CY_EM_EEPROM_SUCCESS != partResult) &&
+         (CY_EM_EEPROM_REDUNDANT_COPY_USED != partResult)))
     {
-        if (isEraseRequired)
-        {
-            eraseResult = context->bd->erase_nb(context->bd->context,
-                                                ((uint32_t)rowAddr),
-                                                context->rowSize);
-        }
-        if (eraseResult == CY_RSLT_SUCCESS)
-        {
-            eraseResult = context->bd->program_nb(context->bd->context,
-                                                  ((uint32_t)rowAddr),
-                                                  context->rowSize,
-                                                  (uint8_t*)ramBuffAddr);
-        }
+        status = partResult;
     }
-    #endif /* defined(MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED) */
-
-    result  = ((eraseResult == CY_RSLT_SUCCESS) ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_WRITE_FAIL);
-    return result;
+    return (status);
 }
 
 
+#if (CY_EM_EEPROM_KV_ENABLE == 1u)
 /*******************************************************************************
-* Function Name: CalculateRowChecksum
+* Function Name: KvFindEntry
 ****************************************************************************//**
 *
-* Calculates a checksum of the row specified by the ptrRow parameter.
-* The first four bytes of the row are overwritten with zeros for calculation
-* since it is the checksum location.
+* Finds a record of the key/value store in the index.
 *
-* \param ptrRow
-* The pointer to a row.
+* \param key
+* The key of the record.
 *
-* \param rowSize
-* The size of the row passed in.
+* \param size
+* The value size of the record or zero for any size.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* The calculated value of CRC-8.
+* The pointer to the index entry of the record or NULL if it is not found.
 *
 *******************************************************************************/
-static uint32_t CalculateRowChecksum(const uint32_t* ptrRow, uint32_t rowSize)
+static cy_stc_em_eeprom_kv_entry_t* KvFindEntry(
+    uint16_t key,
+    uint32_t size,
+    const cy_stc_eeprom_context_t* context)
 {
-    return ((uint32_t)CalcChecksum((const uint8_t*)((uint32_t)ptrRow + 1u),
-                                   (rowSize) - CY_EM_EEPROM_U32));
+    cy_stc_em_eeprom_kv_entry_t* entry = NULL;
+    uint32_t i;
+
+    for (i = 0u; (i < context->kvNumRecords) && (NULL == entry); i++)
+    {
+        if ((key == context->kvIndex[i].key) &&
+            ((0u == size) || (size == context->kvIndex[i].size)))
+        {
+            entry = &context->kvIndex[i];
+        }
+    }
+    return entry;
 }
 
 
 /*******************************************************************************
-* Function Name: GetStoredRowChecksum
+* Function Name: KvWrite
 ****************************************************************************//**
 *
-* Returns the stored in the row checksum. The row specified by the ptrRow parameter.
-* The first four bytes of the row is the checksum.
+* Writes a part of a key/value store record. Only the changed bytes are
+* written.
 *
-* \param ptrRow
-* The pointer to a row.
+* \param addr
+* The logical address in the Em_EEPROM storage.
+*
+* \param data
+* The pointer to the data to write.
+*
+* \param size
+* The size of the data in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* The stored row checksum.
+* CY_EM_EEPROM_SUCCESS if the data is written, CY_EM_EEPROM_WRITE_FAIL otherwise.
+* The checksum status of the other rows reported by Cy_Em_EEPROM_WriteDelta()
+* is not relevant for the record.
 *
 *******************************************************************************/
-static uint32_t GetStoredRowChecksum(const uint32_t* ptrRow)
+static cy_en_em_eeprom_status_t KvWrite(
+    uint32_t addr,
+    const void* data,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
 {
-    #if (CPUSS_FLASHC_ECT == 1)
-    uint32_t ret = 0U;
-    if (!WorkFlashIsErased((uint32_t*)&ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32], 4))
-    {
-        ret = ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32];
-    }
-    return (ret);
-    #else /* (CPUSS_FLASHC_ECT == 1) */
-    return (ptrRow[CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET_U32]);
-    #endif /* (CPUSS_FLASHC_ECT == 1) */
+    cy_en_em_eeprom_status_t result = Cy_Em_EEPROM_WriteDelta(addr, data, size, context);
+
+    return ((CY_EM_EEPROM_WRITE_FAIL == result) ? CY_EM_EEPROM_WRITE_FAIL : CY_EM_EEPROM_SUCCESS);
 }
 
 
 /*******************************************************************************
-* Function Name: CheckRowChecksum
+* Function Name: KvWriteRecordHeader
 ****************************************************************************//**
 *
-* Checks if the specified row has a valid stored CRC.
+* Writes the header of a key/value store record.
 *
-* \param ptrRow
-* The pointer to a row.
+* \param addr
+* The logical address of the record in the Em_EEPROM storage.
 *
-* \param rowSize
-* The size of the row passed in.
+* \param key
+* The key of the record.
+*
+* \param size
+* The value size of the record.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* Returns the operation status. See cy_en_em_eeprom_status_t.
+* CY_EM_EEPROM_SUCCESS if the header is written, CY_EM_EEPROM_WRITE_FAIL otherwise.
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t CheckRowChecksum(const uint32_t* ptrRow, uint32_t rowSize)
+static cy_en_em_eeprom_status_t KvWriteRecordHeader(
+    uint32_t addr,
+    uint16_t key,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
 {
-    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_CHECKSUM;
-    #if (CPUSS_FLASHC_ECT == 1)
-    uint32_t lc_buf[CY_EM_EEPROM_MAXIMUM_ROW_SIZE / 4U];
+    uint8_t recordHeader[CY_EM_EEPROM_KV_RECORD_HEADER_SIZE];
 
-    if (WorkFlashIsErased((uint32_t*)ptrRow, rowSize))
-    {
-        /* Fills the RAM buffer with flash data for the case when not a whole row is requested to be
-           overwritten */
-        (void)memset((void*)lc_buf, 0, rowSize);
-    }
-    else
-    {
-        (void)memcpy((void*)lc_buf, (const void*)ptrRow, rowSize);
-    }
-    if (GetStoredRowChecksum(ptrRow) == CalculateRowChecksum(lc_buf, rowSize))
-    {
-        result = CY_EM_EEPROM_SUCCESS;
-    }
+    KvSetRecordHeader(recordHeader, key, size);
 
-    #else /* (CPUSS_FLASHC_ECT == 1) */
-    if (GetStoredRowChecksum(ptrRow) == CalculateRowChecksum(ptrRow, rowSize))
-    {
-        result = CY_EM_EEPROM_SUCCESS;
-    }
-    #endif /* (CPUSS_FLASHC_ECT == 1) */
-    return (result);
+    return KvWrite(addr, recordHeader, CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, context);
 }
 
 
 /*******************************************************************************
-* Function Name: GetStoredSeqNum
+* Function Name: KvFindSlot
 ****************************************************************************//**
 *
-* Returns the stored in the row seqNum (Sequence Number).
-* The row specified by ptrRow parameter.
-* The second four bytes of the row is the seqNum.
+* Finds a deleted record to reuse for a new record. The deleted record is
+* either of the same size or large enough to be split into the new record and
+* a deleted record of at least one byte.
 *
-* \param ptrRow
-* The pointer to a row.
+* \param size
+* The value size of the new record.
+*
+* \param minAddr
+* The lowest address of the deleted record.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* The stored sequence number.
+* The pointer to the index entry of the deleted record or NULL if it is not
+* found.
 *
 *******************************************************************************/
-static uint32_t GetStoredSeqNum(const uint32_t* ptrRow)
+static cy_stc_em_eeprom_kv_entry_t* KvFindSlot(
+    uint32_t size,
+    uint32_t minAddr,
+    const cy_stc_eeprom_context_t* context)
 {
-    #if (CPUSS_FLASHC_ECT == 1)
-    uint32_t ret = 0U;
-    if (!WorkFlashIsErased((uint32_t*)&ptrRow[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32], 4))
+    cy_stc_em_eeprom_kv_entry_t* slot = NULL;
+    const cy_stc_em_eeprom_kv_entry_t* entry;
+    uint32_t i;
+
+    for (i = 0u; (i < context->kvNumRecords) && (NULL == slot); i++)
     {
-        ret = ptrRow[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32];
+        entry = &context->kvIndex[i];
+        /* The split needs an index entry for the rest of the deleted record */
+        if ((CY_EM_EEPROM_KV_KEY_DELETED == entry->key) && (entry->addr >= minAddr) &&
+            ((size == entry->size) ||
+             ((entry->size > (size + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE)) &&
+              (context->kvNumRecords < context->kvIndexSize))))
+        {
+            slot = &context->kvIndex[i];
+        }
     }
-    return (ret);
-    #else /* (CPUSS_FLASHC_ECT == 1) */
-    return (ptrRow[CY_EM_EEPROM_HEADER_SEQ_NUM_OFFSET_U32]);
-    #endif /* (CPUSS_FLASHC_ECT == 1) */
+    return slot;
 }
 
 
 /*******************************************************************************
-* Function Name: DefineLastWrittenRow
+* Function Name: KvAddRecord
 ****************************************************************************//**
 *
-* Performs a search of the last written row address of the Em_EEPROM associated
-* with the context structure. If there were no writes to the Em_EEPROM, the
-* the Em_EEPROM start address is used.
+* Writes a new record to a deleted record found by KvFindSlot() or after
+* the last record. The value is written before the record header, so
+* the record is not in the list until the value is complete.
+*
+* \param key
+* The key of the record.
+*
+* \param data
+* The pointer to the value, or NULL to copy the value from srcAddr.
+*
+* \param srcAddr
+* The logical address of the value to copy if data is NULL.
+*
+* \param size
+* The value size of the record.
+*
+* \param minAddr
+* The lowest address of the record.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* Returns the operation status. See cy_en_em_eeprom_status_t.
+* CY_EM_EEPROM_SUCCESS if the record is written, CY_EM_EEPROM_NO_SPACE if
+* there is no space for it, CY_EM_EEPROM_WRITE_FAIL otherwise.
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t DefineLastWrittenRow(cy_stc_eeprom_context_t* context)
+static cy_en_em_eeprom_status_t KvAddRecord(
+    uint16_t key,
+    const void* data,
+    uint32_t srcAddr,
+    uint32_t size,
+    uint32_t minAddr,
+    cy_stc_eeprom_context_t* context)
 {
-    uint32_t numRows;
-    uint32_t rowIndex;
-    uint32_t seqNum;
-    uint32_t seqNumMax;
-    uint32_t* ptrRow;
-    uint32_t* ptrRowMax;
-    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
-
-    context->ptrLastWrittenRow = (uint32_t*)context->userNvmStartAddr;
-
-    if (0u == context->simpleMode)
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_NO_SPACE;
+    cy_stc_em_eeprom_kv_entry_t* slot = KvFindSlot(size, minAddr, context);
+    uint32_t recordAddr = context->kvFreeAddr;
+    uint32_t nextAddr;
+    uint32_t restSize = 0u;
+    uint32_t slotIndex;
+
+    if (NULL != slot)
     {
-        seqNumMax = 0u;
-        numRows = context->numberOfRows * context->wearLevelingFactor;
-        ptrRow = (uint32_t*)context->userNvmStartAddr;
-        ptrRowMax = ptrRow;
-
-        for (rowIndex = 0u; rowIndex < numRows; rowIndex++)
+        recordAddr = slot->addr;
+        nextAddr = recordAddr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + size;
+        restSize = slot->size - size;
+        result = CY_EM_EEPROM_SUCCESS;
+        if (0u != restSize)
         {
-            seqNum = GetStoredSeqNum(ptrRow);
-            /* Is it a bigger number? */
-            if (seqNum > seqNumMax)
+            /* The rest of the split deleted record is in the list with the new record */
+            result = KvWriteRecordHeader(nextAddr, CY_EM_EEPROM_KV_KEY_DELETED,
+                                         restSize - CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, context);
+        }
+    }
+    else
+    {
+        nextAddr = recordAddr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + size;
+        if ((context->kvNumRecords < context->kvIndexSize) && (nextAddr <= context->eepromSize))
+        {
+            result = CY_EM_EEPROM_SUCCESS;
+            if ((nextAddr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE) < context->eepromSize)
             {
-                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, context->rowSize))
-                {
-                    seqNumMax = seqNum;
-                    ptrRowMax = ptrRow;
-                }
+                /* Ends the list after the new record, as the storage after the last record
+                 * may hold the records removed by the compaction.
+                 */
+                result = KvWriteRecordHeader(nextAddr, CY_EM_EEPROM_KV_KEY_END, 0u, context);
             }
-            /* Switches to the next row */
-            ptrRow += (context->rowSize/4);
         }
+    }
 
-        /* Does the same search algorithm through the redundant copy if enabled */
-        if (0u != context->redundantCopy)
+    if ((CY_EM_EEPROM_SUCCESS == result) && (NULL != data))
+    {
+        result = KvWrite(recordAddr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, data, size, context);
+    }
+    else if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        result = KvCopyValue(recordAddr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, srcAddr, size,
+                             context);
+    }
+    else
+    {
+        /* There is no space for the record */
+    }
+    if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        result = KvWriteRecordHeader(recordAddr, key, size, context);
+    }
+    if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        if (NULL == slot)
         {
-            for (rowIndex = 0u; rowIndex < numRows; rowIndex++)
-            {
-                seqNum = GetStoredSeqNum(ptrRow);
-                /* Is it a bigger number? */
-                if (seqNum > seqNumMax)
-                {
-                    if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, context->rowSize))
-                    {
-                        seqNumMax = seqNum;
-                        ptrRowMax = ptrRow;
-                        result = CY_EM_EEPROM_REDUNDANT_COPY_USED;
-                    }
-                }
-                /* Switches to the next row */
-                ptrRow += (context->rowSize /4);
-            }
+            slot = &context->kvIndex[context->kvNumRecords];
+            context->kvNumRecords++;
+            context->kvFreeAddr = nextAddr;
+        }
+        else if (0u != restSize)
+        {
+            /* Inserts the rest after the new record, so the index stays in the address order */
+            slotIndex = (uint32_t)(slot - context->kvIndex);
+            (void)memmove(&slot[2u], &slot[1u], (context->kvNumRecords - slotIndex - 1u) *
+                          sizeof(cy_stc_em_eeprom_kv_entry_t));
+            slot[1u].key = CY_EM_EEPROM_KV_KEY_DELETED;
+            slot[1u].size = (uint16_t)(restSize - CY_EM_EEPROM_KV_RECORD_HEADER_SIZE);
+            slot[1u].addr = nextAddr;
+            context->kvNumRecords++;
+        }
+        else
+        {
+            /* The deleted record is reused as is */
         }
-        context->ptrLastWrittenRow = ptrRowMax;
+        slot->key = key;
+        slot->size = (uint16_t)size;
+        slot->addr = recordAddr;
     }
 
     return result;
@@ -1235,459 +5102,478 @@ static cy_en_em_eeprom_status_t DefineLastWrittenRow(cy_stc_eeprom_context_t* co
 
 
 /*******************************************************************************
-* Function Name: CheckLastWrittenRowIntegrity
+* Function Name: KvCompact
 ****************************************************************************//**
 *
-* Checks the CRC of the last written row. If CRC is valid then the function
-* stores sequence number into the provided ptrSeqNum pointer. If CRC of the
-* last written row is invalid, then the function searches for the row with
-* the highest sequence number and valid CRC. In this case, the pointer to the
-* last written row is redefined inside context structure and the sequence
-* number of this row is returned.
-*
-* If the redundant copy is enabled, then the copy also considered at
-* the correct CRC verification and sequence number searching.
-*
-* If Simple Mode is enabled, the sequence number is not available and
-* this function returns 0.
+* Reclaims the space of the deleted records. The adjacent deleted records are
+* merged, a record that fits in the deleted record before it is moved there,
+* so the deleted space moves toward the end, and the deleted records at
+* the end are removed from the list. If the next record does not fit in
+* the deleted record, the last record that fits is moved there instead, or
+* else the next record is relocated after itself, so its space merges with
+* the deleted record. Each step is one record header write, or
+* a value copy to the deleted space followed by one, so the list stays valid
+* if a reset interrupts the compaction.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
-* \param ptrSeqNum
-* The pointer to the sequence number.
-*
 * \return
-* Returns the operation status. See cy_en_em_eeprom_status_t.
+* This function returns cy_en_em_eeprom_status_t.
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t CheckLastWrittenRowIntegrity(
-    uint32_t* ptrSeqNum,
-    cy_stc_eeprom_context_t* context)
+static cy_en_em_eeprom_status_t KvCompact(cy_stc_eeprom_context_t* context)
 {
     cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
-
-    const uint32_t* ptrRowCopy;
-    uint32_t seqNum = 0u;
-
-    if (0u == context->simpleMode)
+    cy_stc_em_eeprom_kv_entry_t* entry;
+    cy_stc_em_eeprom_kv_entry_t* record;
+    uint32_t mergedSize;
+    uint32_t swapSize;
+    uint32_t i = 0u;
+    bool isMerged;
+
+    while ((i < context->kvNumRecords) && (CY_EM_EEPROM_SUCCESS == result))
     {
-        /* Checks the row CRC */
-        if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(context->ptrLastWrittenRow, context->rowSize))
+        entry = &context->kvIndex[i];
+        isMerged = false;
+        if (CY_EM_EEPROM_KV_KEY_DELETED != entry->key)
         {
-            seqNum = GetStoredSeqNum(context->ptrLastWrittenRow);
+            i++;
         }
-        else
+        else if ((i + 1u) == context->kvNumRecords)
         {
-            /* CRC is bad. Checks if the redundant copy if enabled */
-            if (0u != context->redundantCopy)
+            /* The deleted record at the end becomes the end of the list */
+            result = KvWriteRecordHeader(entry->addr, CY_EM_EEPROM_KV_KEY_END, 0u, context);
+            if (CY_EM_EEPROM_SUCCESS == result)
             {
-                /* Calculates the redundant copy pointer */
-                ptrRowCopy = ((context->numberOfRows * context->wearLevelingFactor) *
-                              (context->rowSize/4)) + context->ptrLastWrittenRow;
-
-                /* Checks CRC of the redundant copy */
-                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowCopy, context->rowSize))
-                {
-                    seqNum = GetStoredSeqNum(ptrRowCopy);
-                    result = CY_EM_EEPROM_REDUNDANT_COPY_USED;
-                }
-                else
+                context->kvFreeAddr = entry->addr;
+                context->kvNumRecords--;
+            }
+        }
+        else if (CY_EM_EEPROM_KV_KEY_DELETED == entry[1u].key)
+        {
+            mergedSize = (uint32_t)entry->size + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE +
+                         entry[1u].size;
+            if (CY_EM_EEPROM_KV_SIZE_MAX >= mergedSize)
+            {
+                result = KvWriteRecordHeader(entry->addr, CY_EM_EEPROM_KV_KEY_DELETED, mergedSize,
+                                             context);
+                if (CY_EM_EEPROM_SUCCESS == result)
                 {
-                    (void)DefineLastWrittenRow(context);
-                    if (CY_EM_EEPROM_SUCCESS ==
-                        CheckRowChecksum(context->ptrLastWrittenRow, context->rowSize))
-                    {
-                        seqNum = GetStoredSeqNum(context->ptrLastWrittenRow);
-                    }
-                    result = CY_EM_EEPROM_BAD_CHECKSUM;
+                    entry->size = (uint16_t)mergedSize;
+                    (void)memmove(&entry[1u], &entry[2u], (context->kvNumRecords - i - 2u) *
+                                  sizeof(cy_stc_em_eeprom_kv_entry_t));
+                    context->kvNumRecords--;
                 }
             }
             else
             {
-                (void)DefineLastWrittenRow(context);
-                if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(context->ptrLastWrittenRow,
-                                                             context->rowSize))
+                i++;
+            }
+        }
+        else
+        {
+            /* A small record and the deleted record before it are swapped by one write */
+            swapSize = (2u * CY_EM_EEPROM_KV_RECORD_HEADER_SIZE) + entry->size + entry[1u].size;
+            if ((CY_EM_EEPROM_KV_COPY_SIZE >= swapSize) &&
+                ((0u != context->simpleMode) || (context->headerDataLength >= swapSize)))
+            {
+                result = KvSwapRecord(entry, context);
+            }
+            else if ((entry->size == entry[1u].size) ||
+                     (entry->size > (entry[1u].size + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE)))
+            {
+                result = KvMoveRecord(entry, context);
+            }
+            else
+            {
+                /* The next record does not fit in the deleted record. The last record that
+                 * fits is moved there. Otherwise, the next record is relocated after itself,
+                 * and its space is merged with the deleted record by the next step.
+                 */
+                record = KvFindMovableRecord(i, context);
+                if (NULL != record)
                 {
-                    seqNum = GetStoredSeqNum(context->ptrLastWrittenRow);
+                    result = KvRelocateRecord(record, entry->addr, context);
                 }
-                result = CY_EM_EEPROM_BAD_CHECKSUM;
+                else
+                {
+                    result = KvRelocateRecord(&entry[1u], entry[1u].addr + 1u, context);
+                    isMerged = (CY_EM_EEPROM_SUCCESS == result);
+                }
+                if (CY_EM_EEPROM_NO_SPACE == result)
+                {
+                    /* The records are kept */
+                    result = CY_EM_EEPROM_SUCCESS;
+                }
+            }
+            if (!isMerged)
+            {
+                i++;
             }
         }
     }
-    *ptrSeqNum = seqNum;
 
     return result;
 }
 
 
 /*******************************************************************************
-* Function Name: GetNextRowPointer
+* Function Name: KvRelocateRecord
 ****************************************************************************//**
 *
-* Increments the row pointer and performs out of the Em_EEPROM range verification.
-* The memory range is defined as the number of rows multiplied by the wear leveling
-* factor. It does not include the redundant copy area.
+* Copies a record to a deleted record found by KvFindSlot() or after the last
+* record, as Cy_Em_EEPROM_KvSet() writes a new record of an existing key, then
+* deletes the record. Until the record is deleted, both records have the same
+* value, so Cy_Em_EEPROM_KvInit() may keep either of them.
 *
-* \param ptrRow
-* The pointer to the nvm row.
+* \param record
+* The index entry of the record to relocate.
+*
+* \param minAddr
+* The lowest address of the new place of the record.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* Returns the pointer to the next row.
+* CY_EM_EEPROM_SUCCESS if the record is relocated, CY_EM_EEPROM_NO_SPACE if
+* there is no space for it, or the status of the failed copy or write.
 *
 *******************************************************************************/
-static uint32_t* GetNextRowPointer(
-    uint32_t* ptrRow,
-    const cy_stc_eeprom_context_t* context)
+static cy_en_em_eeprom_status_t KvRelocateRecord(
+    cy_stc_em_eeprom_kv_entry_t* record,
+    uint32_t minAddr,
+    cy_stc_eeprom_context_t* context)
 {
-    uint32_t wlEndAddr = ((context->rowSize * context->numberOfRows) *
-                          context->wearLevelingFactor) + context->userNvmStartAddr;
-    uint32_t* lc_ptrRow = ptrRow;
-
-    /* Gets the pointer to the next row to be processed without the range verification */
-    lc_ptrRow += (context->rowSize /sizeof(uint32_t));
+    cy_en_em_eeprom_status_t result;
+    uint16_t key = record->key;
+    uint32_t size = record->size;
+    uint32_t addr = record->addr;
+    uint32_t i;
 
-    if ((uint32_t)lc_ptrRow >= wlEndAddr)
+    result = KvAddRecord(key, NULL, addr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, size, minAddr,
+                         context);
+    if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        result = KvWriteRecordHeader(addr, CY_EM_EEPROM_KV_KEY_DELETED, size, context);
+    }
+    if (CY_EM_EEPROM_SUCCESS == result)
     {
-        lc_ptrRow = (uint32_t*)context->userNvmStartAddr;
+        /* The split of a deleted record may shift the index entry of the record */
+        for (i = 0u; i < context->kvNumRecords; i++)
+        {
+            if (addr == context->kvIndex[i].addr)
+            {
+                context->kvIndex[i].key = CY_EM_EEPROM_KV_KEY_DELETED;
+            }
+        }
     }
-    return (lc_ptrRow);
+
+    return result;
 }
 
 
 /*******************************************************************************
-* Function Name: GetReadRowPointer
+* Function Name: KvFindMovableRecord
 ****************************************************************************//**
 *
-* Calculates the row pointer to be used to read historic and headers data.
+* Finds the last record after the record next to a deleted record that fits
+* in the deleted record, as KvFindSlot() requires.
 *
-* \param ptrRow
-* The pointer to the nvm row.
+* \param holeIndex
+* The index of the entry of the deleted record.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* Returns the pointer to the row where data is read from.
+* The pointer to the index entry of the record or NULL if it is not found.
 *
 *******************************************************************************/
-static uint32_t* GetReadRowPointer(
-    uint32_t* ptrRow,
+static cy_stc_em_eeprom_kv_entry_t* KvFindMovableRecord(
+    uint32_t holeIndex,
     const cy_stc_eeprom_context_t* context)
 {
-    uint32_t wlBlockSize;
-    uint32_t* lc_ptrRow = ptrRow;
+    cy_stc_em_eeprom_kv_entry_t* record = NULL;
+    const cy_stc_em_eeprom_kv_entry_t* entry;
+    uint32_t holeSize = context->kvIndex[holeIndex].size;
+    uint32_t i;
 
-    /* Adjusts the row read pointer if wear leveling is enabled */
-    if (context->wearLevelingFactor > 1u)
+    for (i = context->kvNumRecords - 1u; (i > (holeIndex + 1u)) && (NULL == record); i--)
     {
-        /* The size of one wear-leveling block */
-        wlBlockSize = context->numberOfRows * (context->rowSize);
-        /* Checks if it is the first block of the wear leveling */
-        if (((uint32_t)lc_ptrRow) < (context->userNvmStartAddr + wlBlockSize))
+        entry = &context->kvIndex[i];
+        if ((CY_EM_EEPROM_KV_KEY_DELETED != entry->key) &&
+            ((holeSize == entry->size) ||
+             ((holeSize > (entry->size + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE)) &&
+              (context->kvNumRecords < context->kvIndexSize))))
         {
-            /* Jumps to the last wear-leveling block */
-            lc_ptrRow =
-                (uint32_t*)((uint32_t)lc_ptrRow +
-                            (wlBlockSize * (context->wearLevelingFactor - 1u)));
-        }
-        else
-        {
-            /* Decreases the read pointer for one wear-leveling block */
-            lc_ptrRow = (uint32_t*)((uint32_t)lc_ptrRow - wlBlockSize);
+            record = &context->kvIndex[i];
         }
     }
-    return (lc_ptrRow);
+    return record;
 }
 
 
 /*******************************************************************************
-* Function Name: CopyHistoricData
+* Function Name: KvMoveRecord
 ****************************************************************************//**
 *
-* Copies relevant historic data into the specified buffer.
-*
-* The function includes the proper handling of the redundant copy and wear leveling
-* if enabled.
+* Moves the record after a deleted record to the start of the deleted record.
+* The deleted record moves after the moved record. Until the old record is
+* deleted, both records have the same value, so Cy_Em_EEPROM_KvInit() may
+* keep either of them.
 *
-* \param ptrRowWrite
-* The pointer to the buffer to store historic data.
-*
-* \param ptrRow
-* The pointer to the current active nvm row.
+* \param entry
+* The index entry of the deleted record. The next entry is the record to move.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
 * \return
-* Returns the operation status. See cy_en_em_eeprom_status_t.
+* This function returns cy_en_em_eeprom_status_t.
 *
 *******************************************************************************/
-static cy_en_em_eeprom_status_t CopyHistoricData(
-    uint32_t* ptrRowWrite,
-    uint32_t* ptrRow,
-    const cy_stc_eeprom_context_t* context)
+static cy_en_em_eeprom_status_t KvMoveRecord(
+    cy_stc_em_eeprom_kv_entry_t* entry,
+    cy_stc_eeprom_context_t* context)
 {
-    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_BAD_CHECKSUM;
-    cy_rslt_t readResult = CY_RSLT_SUCCESS;
-    uint32_t historicDataOffsetU32 = ((context->rowSize /4) /2);
-    const uint32_t* ptrRowRead = GetReadRowPointer(ptrRow, context);
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    cy_stc_em_eeprom_kv_entry_t* record = &entry[1u];
+    uint32_t holeSize = entry->size;
+    uint32_t newAddr = entry->addr;
+    uint32_t restAddr = newAddr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + record->size;
 
-    if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowRead, context->rowSize))
+    if (holeSize != record->size)
     {
-        readResult = context->bd->read(context->bd->context,
-                                       (uint32_t)&ptrRowRead[historicDataOffsetU32],
-                                       context->byteInRow,
-                                       (uint8_t*)&ptrRowWrite[historicDataOffsetU32]);
-        result = (readResult == CY_RSLT_SUCCESS) ? CY_EM_EEPROM_SUCCESS : CY_EM_EEPROM_BAD_DATA;
+        /* The rest of the deleted record before the old record */
+        result = KvWriteRecordHeader(restAddr, CY_EM_EEPROM_KV_KEY_DELETED,
+                                     (holeSize - record->size) -
+                                     CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, context);
     }
-    else
+    if (CY_EM_EEPROM_SUCCESS == result)
     {
-        /* CRC is bad. Checks if the redundant copy if enabled */
-        if (0u != context->redundantCopy)
+        result = KvCopyValue(newAddr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE,
+                             record->addr + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE, record->size,
+                             context);
+    }
+    if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        result = KvWriteRecordHeader(newAddr, record->key, record->size, context);
+    }
+    if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        result = KvWriteRecordHeader(record->addr, CY_EM_EEPROM_KV_KEY_DELETED, record->size,
+                                     context);
+    }
+    if (CY_EM_EEPROM_SUCCESS == result)
+    {
+        entry->key = record->key;
+        entry->size = record->size;
+        record->key = CY_EM_EEPROM_KV_KEY_DELETED;
+        if (holeSize != record->size)
         {
-            ptrRowRead += ((context->numberOfRows * context->wearLevelingFactor) *
-                           (context->rowSize/4));
-            if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRowRead, context->rowSize))
+            /* Merges the rest of the deleted record with the old record */
+            result = KvWriteRecordHeader(restAddr, CY_EM_EEPROM_KV_KEY_DELETED, holeSize,
+                                         context);
+            if (CY_EM_EEPROM_SUCCESS == result)
             {
-                /* Copies the Em_EEPROM historic data from the redundant copy */
-                readResult = context->bd->read(context->bd->context,
-                                               (uint32_t)&ptrRowRead[historicDataOffsetU32],
-                                               context->byteInRow,
-                                               (uint8_t*)&ptrRowWrite[historicDataOffsetU32]);
-                /* Reports that the redundant copy was used */
-                result =
-                    (readResult ==
-                     CY_RSLT_SUCCESS) ? CY_EM_EEPROM_REDUNDANT_COPY_USED : CY_EM_EEPROM_BAD_DATA;
+                record->size = (uint16_t)holeSize;
+                record->addr = restAddr;
             }
         }
-        if ((0 == GetStoredSeqNum(ptrRowRead)) &&
-            (0 == GetStoredRowChecksum(ptrRowRead)))
-        {
-            /*
-             * Considers a row with a bad checksum as the row that never has never been
-             * written before if the sequence number and CRC values are the erased value.
-             * In this case, reports zeros and does not
-             * report the failed status of the write operation.
-             */
-            result = CY_EM_EEPROM_SUCCESS;
-        }
     }
+
     return result;
 }
 
 
 /*******************************************************************************
-* Function Name: CopyHeadersData
+* Function Name: KvSwapRecord
 ****************************************************************************//**
 *
-* Copies relevant data located in the headers into a row specified by the
-* pointer ptrRow.
-* The function includes the proper handling of a redundant copy and wear leveling
-* if enabled.
-*
-* \param ptrRowWrite
-* The pointer to the buffer where to store the headers data.
+* Swaps the record after a deleted record with the deleted record. Both records
+* are written by one write of up to headerDataLength bytes, which is one row
+* write with Simple mode disabled.
 *
-* \param ptrRow
-* The pointer to the current active nvm row.
+* \param entry
+* The index entry of the deleted record. The next entry is the record to move.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
+* \return
+* This function returns cy_en_em_eeprom_status_t.
+*
 *******************************************************************************/
-static cy_en_em_eeprom_status_t CopyHeadersData(
-    uint32_t* ptrRowWrite,
-    uint32_t* ptrRow,
-    const cy_stc_eeprom_context_t* context)
+static cy_en_em_eeprom_status_t KvSwapRecord(
+    cy_stc_em_eeprom_kv_entry_t* entry,
+    cy_stc_eeprom_context_t* context)
 {
-    uint32_t i;
-    uint32_t strHistAddr;
-    uint32_t endHistAddr;
-    uint32_t strHeadAddr;
-    uint32_t endHeadAddr;
-    uint32_t dstOffset;
-    uint32_t srcOffset;
-    uint32_t sizeToCopy;
-    cy_en_em_eeprom_status_t crcStatus = CY_EM_EEPROM_SUCCESS;
-    uint32_t numReads = context->numberOfRows;
-    uint32_t historicDataOffsetU32 = ((context->rowSize /2u) /4u);
-    uint32_t* ptrRowWork;
-    uint32_t* ptrRowRead = GetReadRowPointer(ptrRow, context);
-    bool readingRam = false;
-
-    /* Skips unwritten rows if any */
-    if (numReads > GetStoredSeqNum(ptrRowWrite))
+    cy_en_em_eeprom_status_t result;
+    cy_stc_em_eeprom_kv_entry_t* record = &entry[1u];
+    uint8_t copyBuffer[CY_EM_EEPROM_KV_COPY_SIZE];
+    uint32_t recordSize = CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + record->size;
+    uint32_t holeSize = entry->size;
+
+    result = Cy_Em_EEPROM_Read(record->addr, copyBuffer, recordSize, context);
+    if (CY_EM_EEPROM_REDUNDANT_COPY_USED == result)
     {
-        numReads = GetStoredSeqNum(ptrRowWrite);
-        /* Only the first N rows have been written so far, only read up to the
-            current row starting from the first row*/
-        ptrRowRead = (uint32_t*)context->userNvmStartAddr;
+        result = CY_EM_EEPROM_SUCCESS;
     }
-    else
+    if (CY_EM_EEPROM_SUCCESS == result)
     {
-        /* No need to check the row about to write since it was checked at the last
-            write, so start with the following row. */
-        ptrRowRead = GetNextRowPointer(ptrRowRead, context);
+        (void)memset(&copyBuffer[recordSize], 0, CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + holeSize);
+        KvSetRecordHeader(&copyBuffer[recordSize], CY_EM_EEPROM_KV_KEY_DELETED, holeSize);
+        result = KvWrite(entry->addr, copyBuffer,
+                         recordSize + CY_EM_EEPROM_KV_RECORD_HEADER_SIZE + holeSize, context);
     }
-
-    if (context->numberOfRows <= 0U)
+    if (CY_EM_EEPROM_SUCCESS == result)
     {
-        crcStatus = CY_EM_EEPROM_WRITE_FAIL;
+        entry->key = record->key;
+        entry->size = record->size;
+        record->key = CY_EM_EEPROM_KV_KEY_DELETED;
+        record->size = (uint16_t)holeSize;
+        record->addr = entry->addr + recordSize;
     }
 
-    if (crcStatus == CY_EM_EEPROM_SUCCESS)
-    {
-        /* The address within the Em_EEPROM storage of historic data of the specified by the ptrRow
-           row */
-        strHistAddr = ((((uint32_t)ptrRow - context->userNvmStartAddr) /
-                        context->rowSize) % context->numberOfRows) *
-                      (context->rowSize / 2u);
-        endHistAddr = strHistAddr + (context->rowSize / 2u);
-
-        for (i = 0u; i < numReads; i++)
-        {
-            ptrRowWork = ptrRowRead;
-
-            /* For the last header-read operation, checks data in the recently created header */
-            if (i >= (numReads - 1u))
-            {
-                ptrRowWork = ptrRowWrite;
-                readingRam = true;
-            }
-            else
-            {
-                /* Checks CRC of the row to be read except the last row of a recently created header
-                 */
-                crcStatus = CheckRowChecksum(ptrRowWork, context->rowSize);
-                if ((CY_EM_EEPROM_SUCCESS != crcStatus) && (0u != context->redundantCopy))
-                {
-                    /* Calculates the redundant copy pointer */
-                    ptrRowWork += ((context->numberOfRows * context->wearLevelingFactor) *
-                                   (context->rowSize/4));
-                    crcStatus = CheckRowChecksum(ptrRowWork, context->rowSize);
-                }
-            }
-
-            /* Skips the row if CRC is bad */
-            if (CY_EM_EEPROM_SUCCESS == crcStatus)
-            {
-                /* The address of header data */
-                strHeadAddr = ptrRowWork[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32];
-                sizeToCopy = ptrRowWork[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32];
-                endHeadAddr = strHeadAddr + sizeToCopy;
+    return result;
+}
 
-                /* Skips the row if the header data address is out of the historic data address
-                   range */
-                if ((strHeadAddr < endHistAddr) && (endHeadAddr > strHistAddr))
-                {
-                    dstOffset = 0u;
-                    srcOffset = 0u;
 
-                    if (strHeadAddr >= strHistAddr)
-                    {
-                        dstOffset = strHeadAddr % context->byteInRow;
-                        if (endHeadAddr > endHistAddr)
-                        {
-                            sizeToCopy = endHistAddr - strHeadAddr;
-                        }
-                    }
-                    else
-                    {
-                        srcOffset = context->byteInRow - (strHeadAddr % context->byteInRow);
-                        sizeToCopy = endHeadAddr - strHistAddr;
-                    }
+/*******************************************************************************
+* Function Name: KvCopyValue
+****************************************************************************//**
+*
+* Copies a record value in the Em_EEPROM storage by parts of
+* CY_EM_EEPROM_KV_COPY_SIZE bytes.
+*
+* \param dstAddr
+* The logical address to copy the value to.
+*
+* \param srcAddr
+* The logical address of the value.
+*
+* \param size
+* The size of the value in bytes.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* CY_EM_EEPROM_SUCCESS if the value is copied, CY_EM_EEPROM_BAD_CHECKSUM if
+* it is read from a row with a bad checksum, CY_EM_EEPROM_WRITE_FAIL otherwise.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t KvCopyValue(
+    uint32_t dstAddr,
+    uint32_t srcAddr,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
+{
+    cy_en_em_eeprom_status_t result = CY_EM_EEPROM_SUCCESS;
+    uint8_t copyBuffer[CY_EM_EEPROM_KV_COPY_SIZE];
+    uint32_t pos = 0u;
+    uint32_t partSize;
 
-                    if (readingRam == true)
-                    {
-                        (void)memcpy((uint8_t*)((uint32_t)(&ptrRowWrite[historicDataOffsetU32]) +
-                                                dstOffset),
-                                     (const uint8_t*)((uint32_t)(&ptrRowWork[
-                                                                     CY_EM_EEPROM_HEADER_DATA_OFFSET_U32
-                                                                 ]) + srcOffset),
-                                     sizeToCopy);
-                    }
-                    else
-                    {
-                        context->bd->read(context->bd->context,
-                                          (uint32_t)(&ptrRowWork[CY_EM_EEPROM_HEADER_DATA_OFFSET_U32
-                                                     ]) +
-                                          srcOffset,
-                                          sizeToCopy,
-                                          (uint8_t*)((uint32_t)(&ptrRowWrite[historicDataOffsetU32])
-                                                     +
-                                                     dstOffset));
-                    }
-                }
-            }
-            ptrRowRead = GetNextRowPointer(ptrRowRead, context);
+    while ((pos < size) && (CY_EM_EEPROM_SUCCESS == result))
+    {
+        partSize = ((size - pos) < CY_EM_EEPROM_KV_COPY_SIZE) ? (size - pos) :
+                   CY_EM_EEPROM_KV_COPY_SIZE;
+        result = Cy_Em_EEPROM_Read(srcAddr + pos, copyBuffer, partSize, context);
+        if (CY_EM_EEPROM_REDUNDANT_COPY_USED == result)
+        {
+            result = CY_EM_EEPROM_SUCCESS;
         }
-        crcStatus = CY_EM_EEPROM_SUCCESS;
+        if (CY_EM_EEPROM_SUCCESS == result)
+        {
+            result = KvWrite(dstAddr + pos, copyBuffer, partSize, context);
+        }
+        pos += partSize;
     }
-    return (crcStatus);
+
+    return result;
 }
 
 
 /*******************************************************************************
-* Function Name: GetPhysicalSize
+* Function Name: KvIsValueEqual
 ****************************************************************************//**
 *
-* Returns the size of nvm allocated for Em_EEPROM including wear leveling
-* and a redundant copy overhead
+* Compares a record value in the Em_EEPROM storage with the data by parts of
+* CY_EM_EEPROM_KV_COPY_SIZE bytes.
+*
+* \param addr
+* The logical address of the value.
+*
+* \param data
+* The pointer to the data.
+*
+* \param size
+* The size of the value in bytes.
 *
 * \param context
 * The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
 *
-* \param config
-* The pointer to the configuration structure.
+* \return
+* Returns true if the value is read without a bad checksum and equals the data.
 *
 *******************************************************************************/
-static uint32_t GetPhysicalSize(
-    const cy_stc_eeprom_context_t* context,
-    const cy_stc_eeprom_config2_t* config)
+static bool KvIsValueEqual(
+    uint32_t addr,
+    const void* data,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context)
 {
-    /** Defines the size of nvm without wear leveling and redundant copy overhead */
-    uint32_t num_data = context->numberOfRows * (context->rowSize);
+    cy_en_em_eeprom_status_t retRead;
+    uint8_t copyBuffer[CY_EM_EEPROM_KV_COPY_SIZE];
+    const uint8_t* ptrData = data;
+    bool isEqual = true;
+    uint32_t pos = 0u;
+    uint32_t partSize;
+
+    while ((pos < size) && isEqual)
+    {
+        partSize = ((size - pos) < CY_EM_EEPROM_KV_COPY_SIZE) ? (size - pos) :
+                   CY_EM_EEPROM_KV_COPY_SIZE;
+        retRead = Cy_Em_EEPROM_Read(addr + pos, copyBuffer, partSize, context);
+        isEqual = (((CY_EM_EEPROM_SUCCESS == retRead) ||
+                    (CY_EM_EEPROM_REDUNDANT_COPY_USED == retRead)) &&
+                   (0 == memcmp(copyBuffer, &ptrData[pos], partSize)));
+        pos += partSize;
+    }
 
-    return (num_data * \
-            ((((1uL - (config->simpleMode)) * (config->wearLevelingFactor)) *
-              ((config->redundantCopy) + 1uL)) + (config->simpleMode)));
+    return isEqual;
 }
 
 
 /*******************************************************************************
-* Function Name: ComputeEEPROMProgramSize
+* Function Name: KvSetRecordHeader
 ****************************************************************************//**
 *
-* Makes sure that the program size in EEPROM context is an integer multiple of actual
-* program size coming from the block storage API whenever the actual program size
-* is smaller than the minimum EEPROM ROW SIZE in extended mode. In SimpleMode we have
-* no need for a minimum EEPROM ROW SIZE so we can use the actualProgramSize returned
-* by the block device.
+* Fills the header of a key/value store record.
 *
-* \param context
-* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+* \param recordHeader
+* The buffer of CY_EM_EEPROM_KV_RECORD_HEADER_SIZE bytes for the header.
+*
+* \param key
+* The key of the record.
+*
+* \param size
+* The value size of the record.
 *
 *******************************************************************************/
-static void ComputeEEPROMProgramSize(cy_stc_eeprom_context_t* context)
+static void KvSetRecordHeader(uint8_t* recordHeader, uint16_t key, uint32_t size)
 {
-    uint32_t actualProgramSize =
-        ((uint32_t)context->bd->get_program_size(context->bd->context, context->userNvmStartAddr));
-    if ((actualProgramSize < CY_EM_EEPROM_MINIMUM_ROW_SIZE) && (context->simpleMode == 0))
-    {
-        context->rowSize = (((CY_EM_EEPROM_MINIMUM_ROW_SIZE - 1) / actualProgramSize) + 1) *
-                           actualProgramSize;
-    }
-    else
-    {
-        context->rowSize = actualProgramSize;
-    }
+    recordHeader[0u] = (uint8_t)key;
+    recordHeader[1u] = (uint8_t)(key >> 8u);
+    recordHeader[2u] = (uint8_t)size;
+    recordHeader[3u] = (uint8_t)(size >> 8u);
 }
 
 
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+
 #if (CPUSS_FLASHC_ECT == 1)
 /*******************************************************************************
 * Function Name: WorkFlashIsErased
@@ -1696,19 +5582,20 @@ static void ComputeEEPROMProgramSize(cy_stc_eeprom_context_t* context)
 * Checks if XMC7xxx Work Flash is Blank/Erased state
 *
 * \param addr
-* The pointer to the Work Flash starting address to check for blank
+* The Work Flash starting address to check for blank
 *
 * \param size
 * The size of the Work Flash to check from address passed
 *
 *
 *******************************************************************************/
-static bool WorkFlashIsErased(const uint32_t* addr, uint32_t size)
+static bool WorkFlashIsErased(uint32_t addr, uint32_t size)
 {
     cy_stc_flash_blankcheck_config_t config;
     cy_en_flashdrv_status_t status;
 
-    config.addrToBeChecked = addr;
+    /* The Work Flash is memory mapped at its block device address */
+    config.addrToBeChecked = (uint32_t*)(uintptr_t)addr;
     config.numOfWordsToBeChecked = size / 4U;
 
     status = Cy_Flash_BlankCheck(&config, CY_FLASH_DRIVER_BLOCKING);
@@ -1717,6 +5604,68 @@ static bool WorkFlashIsErased(const uint32_t* addr, uint32_t size)
 }
 
 
+/*******************************************************************************
+* Function Name: WorkFlashRowIsErased
+****************************************************************************//**
+*
+* Checks if the Work Flash row is erased. The result is kept until the end of
+* the Em_EEPROM operation or the next write of the row, so each row is blank
+* checked once per operation.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+* \return
+* Returns true if the row is erased.
+*
+*******************************************************************************/
+static bool WorkFlashRowIsErased(uint32_t rowAddr, const cy_stc_eeprom_context_t* context)
+{
+    bool isErased;
+    uint32_t index = GetRowIndex(rowAddr, context) % CY_EM_EEPROM_ROW_STATE_ENTRIES;
+
+    if ((rowAddr == rowStateAddr[index]) && (CY_EM_EEPROM_ROW_STATE_UNKNOWN != rowState[index]))
+    {
+        isErased = (CY_EM_EEPROM_ROW_STATE_BLANK == rowState[index]);
+    }
+    else
+    {
+        isErased = WorkFlashIsErased(rowAddr, context->rowSize);
+        SetRowState(rowAddr, isErased ? CY_EM_EEPROM_ROW_STATE_BLANK :
+                    CY_EM_EEPROM_ROW_STATE_WRITTEN, context);
+    }
+    return (isErased);
+}
+
+
+/*******************************************************************************
+* Function Name: SetRowState
+****************************************************************************//**
+*
+* Stores the blank check result of the row for the ongoing Em_EEPROM operation.
+*
+* \param rowAddr
+* The address of the nvm row.
+*
+* \param state
+* The row state: CY_EM_EEPROM_ROW_STATE_BLANK or CY_EM_EEPROM_ROW_STATE_WRITTEN.
+*
+* \param context
+* The pointer to the Em_EEPROM context structure \ref cy_stc_eeprom_context_t.
+*
+*******************************************************************************/
+static void SetRowState(uint32_t rowAddr, uint8_t state, const cy_stc_eeprom_context_t* context)
+{
+    uint32_t index = GetRowIndex(rowAddr, context) % CY_EM_EEPROM_ROW_STATE_ENTRIES;
+
+    rowStateAddr[index] = rowAddr;
+    rowState[index] = state;
+}
+
+
 #endif /* (CPUSS_FLASHC_ECT == 1) */
 
 /* [] END OF FILE */
@@ -187,6 +187,7 @@
  *   * \ref section_em_eeprom_appsflash_location
  *   * \ref section_em_eeprom_auxflash_location
  *   * \ref section_em_eeprom_appsflash_fixed
+ * * \ref section_em_eeprom_row_cache
  * * \ref section_em_eeprom_migration
  *
  * Also refer to the \ref section_em_eeprom_miscellaneous for the
@@ -210,12 +211,24 @@
  * erase/write cycles can be done on Em_EEPROM.
  * Multiply this number by the datasheet write endurance spec to determine
  * the max of write cycles.<br>
- * The amount of wear leveling from 1 to 10. 1 means no wear leveling is used.
+ * The amount of wear leveling from 1 to 255. 1 means no wear leveling is used.
  *
  * To configure the wear leveling just set the WEAR_LEVELING macro value from
- * (1u) to (10u) in step #4 in the \ref section_em_eeprom_quick_start section:
+ * (1u) to (255u) in step #4 in the \ref section_em_eeprom_quick_start section:
  * \snippet emeeprom/sut/main.c snippet_configuration_wear
  *
+ * When the available nvm is not a whole multiple of the Em_EEPROM size,
+ * the length of the wear-leveling ring can be set directly in rows with
+ * the \ref cy_stc_eeprom_config2_t.wearLevelingRows parameter of
+ * the Cy_Em_EEPROM_Init_BD() function, with the wearLevelingFactor parameter
+ * set to zero. The ring must be at least as long as the number of rows needed
+ * to store eepromSize. The endurance grows with the ring length
+ * divided by the number of rows needed to store eepromSize.
+ *
+ * Use the Cy_Em_EEPROM_GetRowWear() and Cy_Em_EEPROM_GetRemainingLife()
+ * functions to check the actual wear of the rows and tune the wear leveling
+ * for the real usage.
+ *
  ********************************************************************************
  * \subsubsection section_em_eeprom_mode_redundantcopy Redundant Copy
  ********************************************************************************
@@ -227,6 +240,8 @@
  * while a redundant copy of Em_EEPROM is stored in another location.
  * When data is read, first the checksum is checked. If that checksum is bad,
  * and the redundant copy's checksum is good, the copy is restored.
+ * The bad row stays in nvm, so each read of it checks both copies. Call
+ * Cy_Em_EEPROM_ScrubStep() from idle time to find and rewrite such rows.
  *
  * To configure the redundant copy just set the REDUNDANT_COPY macro value to
  * (1u) or (0u) in step #4 in the \ref section_em_eeprom_quick_start section:
@@ -245,6 +260,10 @@
  * size CY_EM_EEPROM_FLASH_SIZEOF_ROW. The wear leveling and
  * redundant copy features are disabled, i.e. wearLevelingFactor and
  * redundantCopy parameters are ignored.
+ * In Simple mode, the row is the program size of the block device. A write
+ * of a part of a row reads the row and programs it only if its content
+ * changes. The rows overwritten as a whole are programmed directly from
+ * the user's buffer without being read, if the buffer is word-aligned.
  *
  * To configure Simple mode just set the SIMPLE_MODE macro value
  * to (1u) or (0u) in step #4 in the \ref section_em_eeprom_quick_start section:
@@ -300,7 +319,14 @@
  *    The row size is specific for a device family. Refer to the specific
  *    PSoC device datasheet.
  *
- * Use the CY_EM_EEPROM_GET_PHYSICAL_SIZE() macro to get the needed
+ *    If the wear-leveling ring length is specified in rows
+ *    (\ref cy_stc_eeprom_config2_t.wearLevelingRows with wearLevelingFactor
+ *    zero), then:
+ *
+ *    <i>storageSize = wearLevelingRows * CY_EM_EEPROM_FLASH_SIZEOF_ROW * (1 + redundantCopy)</i>
+ *
+ * Use the CY_EM_EEPROM_GET_PHYSICAL_SIZE() or
+ * CY_EM_EEPROM_GET_PHYSICAL_SIZE_WL_ROWS() macro to get the needed
  * storage size depending on the configuration.
  *
  ********************************************************************************
@@ -563,6 +589,16 @@
  *   the <a href="https://community.cypress.com/docs/DOC-15264">
  *   <b>Manage Flash Space for Both Cores of PSoC 6 - KBA224173</b></a>
  *
+ * * The sequence number stored in each Em_EEPROM row is a 56-bit value:
+ *   the 40-bit number of writes, so it does not wrap around within the nvm
+ *   lifetime, and the 16-bit layout id used by Cy_Em_EEPROM_Migrate().
+ *   Rows written by versions before 2.50 are used without conversion.
+ *   The layout id is zero unless the content was moved by
+ *   Cy_Em_EEPROM_Migrate(), so the content can still be read by versions
+ *   before 2.50 until it is migrated or the number of writes exceeds
+ *   0xFFFFFFFF. Bits 32..55 of a written row are never all ones, so the rows
+ *   of the nvm that erases to ones read as never written.
+ *
  * * Writing of multiple rows by single the Cy_Em_EEPROM_Write() function
  *   may lead to the following behavior:
  *   The first row is written, then the device is reset due to power down or other
@@ -572,6 +608,131 @@
  *   the row checksum is valid.
  *
  ********************************************************************************
+ * \subsection section_em_eeprom_row_cache Row Read Cache
+ ********************************************************************************
+ *
+ * All nvm contents are read through the read function of the block device,
+ * a whole row at a time. The rows are kept in a row read cache for the
+ * duration of one Em_EEPROM function call, so the storage does not need to be
+ * memory mapped. With Simple mode disabled, a write or a read accesses up to
+ * numberOfRows recently written rows, and their redundant copies if enabled.
+ * By default, the cache holds one row. For storage with expensive reads, such
+ * as external serial flash, define CY_EM_EEPROM_ROW_CACHE_ENTRIES in the
+ * project to numberOfRows + 1, or twice as much with the redundant copy
+ * enabled, so each row is read at most once per function call. Each cache
+ * entry takes CY_EM_EEPROM_MAXIMUM_ROW_SIZE bytes of RAM.
+ *
+ * A read of up to CY_EM_EEPROM_READ_BITMAP_SIZE bytes walks the active
+ * headers from the newest one and keeps a bitmap of the bytes found. It stops
+ * when all bytes are found and reads the historic data only for the bytes
+ * not held by any active header, so a read of recently written data usually
+ * takes one or two rows. Longer reads read the historic data of the range
+ * and all numberOfRows active headers.
+ *
+ ********************************************************************************
+ * \subsection section_em_eeprom_compression Header Data Compression
+ ********************************************************************************
+ *
+ * With Simple mode disabled, each row holds up to headerDataLength bytes of
+ * the written data, so a longer write takes several rows. With
+ * CY_EM_EEPROM_COMPRESSION_ENABLE defined to 1, the data of a write longer than
+ * headerDataLength is run-length encoded into each row, and a row holds as much
+ * data as fits encoded, up to 65 times headerDataLength for repeated bytes.
+ * The encoded data is used only if it holds more than the plain data, so
+ * writes of random data are not affected. The encoding works in place in
+ * the row buffer and takes no extra RAM.
+ *
+ * Rows with encoded data are read by this version regardless of
+ * CY_EM_EEPROM_COMPRESSION_ENABLE, but not by earlier versions.
+ *
+ ********************************************************************************
+ * \subsection section_em_eeprom_kv Key/Value Store
+ ********************************************************************************
+ *
+ * With CY_EM_EEPROM_KV_ENABLE defined to 1, the Cy_Em_EEPROM_KvSet(),
+ * Cy_Em_EEPROM_KvGet() and Cy_Em_EEPROM_KvDelete() functions store values by
+ * 16-bit keys instead of logical addresses. The records are kept one after
+ * another from the start of the Em_EEPROM storage. Each record holds the key,
+ * the value size and the value. Cy_Em_EEPROM_KvInit() scans the records once
+ * and keeps their keys and addresses in an index array provided by
+ * the application, so the other functions do not search the storage.
+ *
+ * With Simple mode disabled, a change of a value of up to headerDataLength
+ * bytes with the same size writes only the changed bytes of the value with
+ * Cy_Em_EEPROM_WriteDelta(), which is one row write, so a reset leaves either
+ * the old or the new value. A larger value or a value with a new size is
+ * written as a new record after the previous one, which is deleted after
+ * the new record is complete. A new record is written value first, so
+ * a record interrupted by a reset is not found by Cy_Em_EEPROM_KvInit(), and
+ * Cy_Em_EEPROM_KvInit() keeps the later record of a key found twice. An
+ * unchanged value is not written.
+ *
+ * A new record reuses a deleted record of the same size or a larger one,
+ * which is split. When no space is left, Cy_Em_EEPROM_KvSet() compacts
+ * the records: it merges the adjacent deleted records, moves each record that
+ * fits in the deleted record before it, or swaps it with the deleted record by
+ * one write if both fit in headerDataLength bytes, and removes the deleted
+ * records at the end of the list. If the record after a deleted record does
+ * not fit in it, a later record that fits is moved there, or the record is
+ * written again after itself as a new record of its key, so its space merges
+ * with the deleted record. The compaction is repeated while it frees space.
+ * A reset during the compaction leaves a valid list. The space of a deleted
+ * record is not reclaimed only when no record fits in it and no space is left
+ * for a copy of the record after it.
+ *
+ * With Simple mode enabled, the rows are written in place, so a reset during
+ * a write of the key/value store may leave a value partly written.
+ *
+********************************************************************************
+ * \subsection section_em_eeprom_fixed_geometry Fixed Geometry
+ ********************************************************************************
+ *
+ * With Simple mode disabled, the reads and writes find the rows by divisions
+ * by the row size, numberOfRows and the ring length, which are slow on
+ * devices without a hardware divider, such as Cortex-M0+. For a single
+ * Em_EEPROM instance with a known configuration, define
+ * CY_EM_EEPROM_FIXED_GEOMETRY to 1 and the following macros in the project:
+ * * CY_EM_EEPROM_FIXED_ROW_SIZE - the rowSize of the context: the program
+ *   size of the nvm, or its multiple of at least
+ *   CY_EM_EEPROM_MINIMUM_ROW_SIZE bytes for smaller program sizes
+ * * CY_EM_EEPROM_FIXED_EEPROM_SIZE - the eepromSize of the configuration
+ * * CY_EM_EEPROM_FIXED_WEAR_LEVELING_ROWS - the wear-leveling ring length in
+ *   rows: numberOfRows multiplied by wearLevelingFactor, or wearLevelingRows
+ *   of the configuration if wearLevelingFactor is zero
+ *
+ * The geometry then folds to constants, and the divisions by powers of two
+ * to shifts. Cy_Em_EEPROM_Init_BD() returns CY_EM_EEPROM_BAD_PARAM for
+ * Simple mode and any configuration with a different geometry, so
+ * Cy_Em_EEPROM_Migrate() cannot be used with the fixed geometry.
+ *
+********************************************************************************
+ * \subsection section_em_eeprom_regions Hot and Cold Data
+ ********************************************************************************
+ *
+ * With Simple mode disabled, each write of a row copies the historic data
+ * and merges the active headers of numberOfRows rows, and the rows of
+ * the whole ring wear evenly. When a few frequently updated bytes, such as
+ * counters, share the storage with a large block of rarely changed data,
+ * such as calibration, each counter update carries the calibration data
+ * through the ring.
+ *
+ * To separate them, initialize an Em_EEPROM instance for each class of data
+ * with Cy_Em_EEPROM_Init_BD(), each with its own configuration and nvm area:
+ * for example, a small eepromSize with a high wear-leveling factor for
+ * the hot data and a large eepromSize with the factor of 1 for the cold data.
+ * Then describe the logical address space as an array of
+ * \ref cy_stc_em_eeprom_region_t, each region mapping a range of logical
+ * addresses to a range of an instance, and access it with
+ * Cy_Em_EEPROM_RegionRead() and Cy_Em_EEPROM_RegionWrite(). The hot and
+ * cold regions may interleave. A write to a hot region rewrites the rows of
+ * the hot instance only, so its row writes take less time and the cold
+ * instance does not wear.
+ *
+ * The regions of one instance must not overlap, and the ranges of the
+ * instances must be within their eepromSize. A write across regions of
+ * different instances is not atomic.
+ *
+ ********************************************************************************
  * \subsection section_em_eeprom_migration Migration from PSoC Creator
  ********************************************************************************
  *
@@ -642,6 +803,12 @@
  * where the right side of initialization is the Em_EEPROM Component customizer
  * parameters and "emEepromStorage" is the name of the storage.
  *
+ * The \ref cy_stc_eeprom_config2_t.wearLevelingRows field is added in
+ * version 2.50. It is used only when wearLevelingFactor is zero, so
+ * the existing configurations keep their wear-leveling ring.
+ * Cy_Em_EEPROM_Init_BD() returns CY_EM_EEPROM_BAD_DATA for a value that does
+ * not fit the block device.
+ *
  ********************************************************************************
  * \subsubsection section_em_eeprom_migration_function Migration of Function
  ********************************************************************************
@@ -762,6 +929,138 @@
  * <table class="doxtable">
  *   <tr><th>Version</th><th>Changes</th><th>Reason for Change</th></tr>
  *   <tr>
+ *     <td rowspan="25">2.50</td>
+ *     <td>Increased the maximum wear-leveling factor to 255 and added
+ *         the \ref cy_stc_eeprom_config2_t.wearLevelingRows parameter to
+ *         define the wear-leveling ring length in rows when
+ *         wearLevelingFactor is zero</td>
+ *     <td>Scaling the endurance with the available nvm</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Fixed the defect of the Cy_Em_EEPROM_Write() function when data
+ *         written before the wear-leveling ring was filled for the first time
+ *         could be lost</td>
+ *     <td>Fixed Defect</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Fixed the defect when writes did not continue from the last written
+ *         row recovered from the redundant copy</td>
+ *     <td>Fixed Defect</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Fixed the defect of the Cy_Em_EEPROM_Read() function when data of
+ *         wrong rows was returned after a fallback to the redundant copy with
+ *         wear leveling disabled</td>
+ *     <td>Fixed Defect</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Extended the sequence number stored in the rows to 56 bits and
+ *         added the Cy_Em_EEPROM_NumWrites64() function</td>
+ *     <td>The last written row is found correctly after 0xFFFFFFFF writes</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Replaced the ptrLastWrittenRow context field with
+ *         \ref cy_stc_eeprom_context_t.lastWrittenRowAddr and kept nvm
+ *         addresses as block device addresses</td>
+ *     <td>Support of 64-bit hosts</td>
+ *   </tr>
+ *   <tr>
+ *     <td>All nvm contents are read through the block device read function
+ *         instead of accessing the storage directly</td>
+ *     <td>Support of storage that is not memory mapped, such as external
+ *         serial flash</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the row read cache configured with
+ *         \ref CY_EM_EEPROM_ROW_CACHE_ENTRIES</td>
+ *     <td>Fewer block device reads on storage with expensive reads</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the optional statistics \ref cy_stc_em_eeprom_stats_t and
+ *         the Cy_Em_EEPROM_GetStats() function</td>
+ *     <td>Profiling of the Em_EEPROM operations in the field</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the Cy_Em_EEPROM_GetRowWear() and
+ *         Cy_Em_EEPROM_GetRemainingLife() functions</td>
+ *     <td>Monitoring of the nvm wear per row</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the optional Cy_Em_EEPROM_TraceHook() call after each block
+ *         device operation</td>
+ *     <td>Timeline analysis of the Em_EEPROM operations</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the Cy_Em_EEPROM_ScrubStep() function</td>
+ *     <td>Incremental verification and repair of the rows from the redundant
+ *         copy</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Simple mode writes skip the partially written rows that already
+ *         hold the new data</td>
+ *     <td>Fewer program operations and less wear in Simple mode</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Simple mode writes program whole rows directly from the user's
+ *         buffer without reading and comparing them first</td>
+ *     <td>Faster writes of large data in Simple mode</td>
+ *   </tr>
+ *   <tr>
+ *     <td>The blank check result of each Work Flash row is kept for
+ *         the duration of an Em_EEPROM function call</td>
+ *     <td>Fewer blank checks on devices with ECT flash</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the Cy_Em_EEPROM_ReadPtr() function</td>
+ *     <td>Read access to the stored data without copying it</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the optional key/value store functions and
+ *         the CY_EM_EEPROM_KEY_NOT_FOUND and CY_EM_EEPROM_NO_SPACE
+ *         return values</td>
+ *     <td>Storage of values by keys instead of logical addresses</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the optional compression of the header data</td>
+ *     <td>Fewer row writes for long writes of compressible data</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the Cy_Em_EEPROM_WriteDelta() function</td>
+ *     <td>Fewer row writes for updates of a few bytes of large data</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the Cy_Em_EEPROM_WriteImage() function and the host
+ *         image builder tool</td>
+ *     <td>Factory provisioning without writes on the device</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the Cy_Em_EEPROM_Migrate() function and the layout id in
+ *         the upper 16 bits of the sequence number of the migrated rows</td>
+ *     <td>Power-fail safe change of the configuration in a firmware
+ *         update</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the CY_EM_EEPROM_FIXED_GEOMETRY option that fixes
+ *         the geometry at compile time</td>
+ *     <td>Faster reads and writes on devices without a hardware divider</td>
+ *   </tr>
+ *   <tr>
+ *     <td>The derived geometry is computed once by Cy_Em_EEPROM_Init_BD()
+ *         and kept in the context</td>
+ *     <td>The row lookups use shifts and masks instead of divisions</td>
+ *   </tr>
+ *   <tr>
+ *     <td>The reads of up to CY_EM_EEPROM_READ_BITMAP_SIZE bytes resolve
+ *         the active headers newest first and stop when all bytes are
+ *         found</td>
+ *     <td>Fewer row reads for small reads</td>
+ *   </tr>
+ *   <tr>
+ *     <td>Added the Cy_Em_EEPROM_RegionRead() and Cy_Em_EEPROM_RegionWrite()
+ *         functions</td>
+ *     <td>Hot and cold data stored by independent Em_EEPROM instances</td>
+ *   </tr>
+ *   <tr>
  *     <td rowspan="3">2.30</td>
  *     <td>The Em_EEPROM 2.30 introduces dependency to new block storage
  *         abstraction layer. This extends support to all devices that
@@ -965,6 +1264,12 @@ extern "C" {
 /** When redundant copy is enabled and one of the copies has bad CRC and other one valid CRC */
 #define MTB_EM_EEPROM_REDUNDANT_COPY_USED               \
     CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_EM_EEPROM, 4)
+/** The key is not present in the key/value store */
+#define MTB_EM_EEPROM_KEY_NOT_FOUND                 \
+    CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_EM_EEPROM, 5)
+/** There is no space left in the key/value store or its index */
+#define MTB_EM_EEPROM_NO_SPACE                 \
+    CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_EM_EEPROM, 6)
 
 
 
@@ -978,6 +1283,67 @@ extern "C" {
 /** Library minor version */
 #define CY_EM_EEPROM_MW_VERSION_MINOR       (30)
 
+/** Enables collection of the Em_EEPROM statistics in the context structure
+ * (1 - enabled, 0 - disabled). Define it in the project before including this
+ * file. See Cy_Em_EEPROM_GetStats().
+ */
+#if !defined(CY_EM_EEPROM_STATS_ENABLE)
+#define CY_EM_EEPROM_STATS_ENABLE           (0u)
+#endif
+
+/** Enables the key/value store functions (1 - enabled, 0 - disabled).
+ * Define it in the project before including this file. See
+ * \ref section_em_eeprom_kv.
+ */
+#if !defined(CY_EM_EEPROM_KV_ENABLE)
+#define CY_EM_EEPROM_KV_ENABLE              (0u)
+#endif
+
+/** Enables the compression of the header data written with Simple mode
+ * disabled (1 - enabled, 0 - disabled). Define it in the project before
+ * including this file. See \ref section_em_eeprom_compression.
+ */
+#if !defined(CY_EM_EEPROM_COMPRESSION_ENABLE)
+#define CY_EM_EEPROM_COMPRESSION_ENABLE     (0u)
+#endif
+
+/** Returns the current time as a free-running uint32_t counter used for
+ * the time fields of \ref cy_stc_em_eeprom_stats_t and the duration passed to
+ * Cy_Em_EEPROM_TraceHook(). The counter may wrap around. Define it in
+ * the project to a timer read function, for example a SysTick or
+ * a microsecond timer. The time is not collected by default.
+ */
+#if !defined(CY_EM_EEPROM_STATS_TIMESTAMP)
+#define CY_EM_EEPROM_STATS_TIMESTAMP()      (0u)
+#endif
+
+/** Enables the call of Cy_Em_EEPROM_TraceHook() after each block device
+ * operation (1 - enabled, 0 - disabled). Define it in the project before
+ * including this file.
+ */
+#if !defined(CY_EM_EEPROM_TRACE_ENABLE)
+#define CY_EM_EEPROM_TRACE_ENABLE           (0u)
+#endif
+
+/** Indicates that the block device addresses of the Em_EEPROM storage are
+ * the CPU addresses of memory-mapped nvm (1 - mapped, 0 - not mapped). When
+ * it is 1, Cy_Em_EEPROM_ReadPtr() returns pointers to the nvm itself instead
+ * of the row read cache. Define it in the project before including this file.
+ */
+#if !defined(CY_EM_EEPROM_NVM_MEMORY_MAPPED)
+#define CY_EM_EEPROM_NVM_MEMORY_MAPPED      (0u)
+#endif
+
+/** Fixes the geometry of the Em_EEPROM at compile time (1 - fixed, 0 - taken
+ * from the configuration). When it is 1, also define
+ * CY_EM_EEPROM_FIXED_ROW_SIZE, CY_EM_EEPROM_FIXED_EEPROM_SIZE and
+ * CY_EM_EEPROM_FIXED_WEAR_LEVELING_ROWS in the project before including this
+ * file. See \ref section_em_eeprom_fixed_geometry.
+ */
+#if !defined(CY_EM_EEPROM_FIXED_GEOMETRY)
+#define CY_EM_EEPROM_FIXED_GEOMETRY         (0u)
+#endif
+
 
 
 /*******************************************************************************
@@ -998,7 +1364,11 @@ typedef enum
     /** Write to Em_EEPROM failed. */
     CY_EM_EEPROM_WRITE_FAIL   = MTB_EM_EEPROM_WRITE_FAIL,
     /** When redundant copy is enabled and one of the copies has bad CRC and other one valid CRC */
-    CY_EM_EEPROM_REDUNDANT_COPY_USED = MTB_EM_EEPROM_REDUNDANT_COPY_USED
+    CY_EM_EEPROM_REDUNDANT_COPY_USED = MTB_EM_EEPROM_REDUNDANT_COPY_USED,
+    /** The key is not present in the key/value store */
+    CY_EM_EEPROM_KEY_NOT_FOUND = MTB_EM_EEPROM_KEY_NOT_FOUND,
+    /** There is no space left in the key/value store or its index */
+    CY_EM_EEPROM_NO_SPACE = MTB_EM_EEPROM_NO_SPACE
 } cy_en_em_eeprom_status_t;
 
 /** Em_EEPROM configuration structure */
@@ -1036,7 +1406,7 @@ typedef struct
      * but a higher number of erase/write cycles can be done on Em_EEPROM.
      * Multiply this number by the datasheet write endurance spec to determine
      * the max of write cycles.<br>
-     * The amount of wear leveling from 1 to 10. 1 means no wear leveling is used.
+     * The amount of wear leveling from 1 to 255. 1 means no wear leveling is used.
      */
     uint8_t wearLevelingFactor;
 
@@ -1104,7 +1474,8 @@ typedef struct
      * but a higher number of erase/write cycles can be done on Em_EEPROM.
      * Multiply this number by the datasheet write endurance spec to determine
      * the max of write cycles.<br>
-     * The amount of wear leveling from 1 to 10. 1 means no wear leveling is used.
+     * The amount of wear leveling from 1 to 255. 1 means no wear leveling is used.
+     * 0 means the ring length is set by wearLevelingRows.
      */
     uint8_t wearLevelingFactor;
 
@@ -1135,8 +1506,114 @@ typedef struct
      * to the Cy_Em_EEPROM_Init() function.
      */
     uint32_t userNvmStartAddr;
+
+    /**
+     * The length of the wear-leveling ring in rows, excluding the redundant
+     * copy. Use it when the ring is not a whole multiple of the number of rows
+     * needed to store eepromSize. Used only when wearLevelingFactor is zero,
+     * and then it must be not less than the number of rows needed to store
+     * eepromSize. Ignored in simple mode.
+     */
+    uint32_t wearLevelingRows;
 } cy_stc_eeprom_config2_t;
 
+#if (CY_EM_EEPROM_TRACE_ENABLE == 1u) || defined(CY_DOXYGEN)
+/** The block device operation reported to Cy_Em_EEPROM_TraceHook(). */
+typedef enum
+{
+    CY_EM_EEPROM_TRACE_READ,        /**< The read function */
+    CY_EM_EEPROM_TRACE_PROGRAM,     /**< The blocking program function */
+    CY_EM_EEPROM_TRACE_ERASE,       /**< The blocking erase function */
+    CY_EM_EEPROM_TRACE_PROGRAM_NB,  /**< The non-blocking program function */
+    CY_EM_EEPROM_TRACE_ERASE_NB     /**< The non-blocking erase function */
+} cy_en_em_eeprom_trace_op_t;
+#endif /* (CY_EM_EEPROM_TRACE_ENABLE == 1u) || defined(CY_DOXYGEN) */
+
+#if (CY_EM_EEPROM_STATS_ENABLE == 1u) || defined(CY_DOXYGEN)
+/**
+ * The Em_EEPROM statistics collected when \ref CY_EM_EEPROM_STATS_ENABLE is 1.
+ * The statistics are cleared by Cy_Em_EEPROM_Init_BD(). The time fields are
+ * in the units of \ref CY_EM_EEPROM_STATS_TIMESTAMP.
+ */
+typedef struct
+{
+    /** The number of the Cy_Em_EEPROM_Read() calls with valid parameters. */
+    uint32_t numReads;
+
+    /** The number of the Cy_Em_EEPROM_Write() calls with valid parameters. */
+    uint32_t numWrites;
+
+    /** The number of the Cy_Em_EEPROM_Erase() calls. */
+    uint32_t numErases;
+
+    /** The number of nvm rows programmed, including the redundant copy. */
+    uint32_t rowsProgrammed;
+
+    /** The number of nvm rows erased, including the erase before programming. */
+    uint32_t rowsErased;
+
+    /** The number of rows read from the redundant copy because the row in
+     * the main copy had a bad checksum.
+     */
+    uint32_t redundantCopyUsed;
+
+    /** The number of rows rewritten by Cy_Em_EEPROM_ScrubStep() from
+     * the other copy.
+     */
+    uint32_t rowsRepaired;
+
+    /** The number of searches through all rows for the last written row. */
+    uint32_t lastRowRescans;
+
+    /** The number of bytes read with the block device read function. */
+    uint64_t bdReadBytes;
+
+    /** The number of bytes the row checksum was calculated over. */
+    uint64_t crcBytes;
+
+    /** The time spent in Cy_Em_EEPROM_Read(). */
+    uint64_t timeRead;
+
+    /** The time spent in Cy_Em_EEPROM_Write(). */
+    uint64_t timeWrite;
+
+    /** The time spent in Cy_Em_EEPROM_Erase(). */
+    uint64_t timeErase;
+
+    /** The time spent in the block device program and erase functions. */
+    uint64_t timeProgram;
+
+    /** The time spent in searches for the last written row. */
+    uint64_t timeRescan;
+
+    /** The time spent collecting the historic data of a row being written. */
+    uint64_t timeHistoricData;
+
+    /** The time spent merging the data of active headers into a row being
+     * written.
+     */
+    uint64_t timeHeadersData;
+} cy_stc_em_eeprom_stats_t;
+#endif /* (CY_EM_EEPROM_STATS_ENABLE == 1u) || defined(CY_DOXYGEN) */
+
+#if (CY_EM_EEPROM_KV_ENABLE == 1u) || defined(CY_DOXYGEN)
+/**
+ * An entry of the key/value store index. The application provides an array of
+ * the entries to Cy_Em_EEPROM_KvInit(), one entry for each record stored.
+ */
+typedef struct
+{
+    /** The key of the record or CY_EM_EEPROM_KV_KEY_DELETED for a deleted record. */
+    uint16_t key;
+
+    /** The size of the record value in bytes. */
+    uint16_t size;
+
+    /** The logical address of the record in the Em_EEPROM storage. */
+    uint32_t addr;
+} cy_stc_em_eeprom_kv_entry_t;
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) || defined(CY_DOXYGEN) */
+
 /**
  * The Em_EEPROM context data structure. It is used to store specific
  * Em_EEPROM context data.
@@ -1159,7 +1636,7 @@ typedef struct
     /** The number of bytes to store in Em_EEPROM. */
     uint32_t eepromSize;
 
-    /** The amount of wear leveling from 1 to 10. 1 means no wear leveling is used. */
+    /** The amount of wear leveling from 1 to 255. 1 means no wear leveling is used. */
     uint8_t wearLevelingFactor;
 
     /** No headers configured */
@@ -1187,16 +1664,95 @@ typedef struct
      */
     uint16_t headerDataLength;
 
-    /** The pointer to the last written row. */
-    uint32_t* ptrLastWrittenRow;
+    /** The block device address of the last written row. */
+    uint32_t lastWrittenRowAddr;
+
+    /** The number of rows in the wear-leveling ring excluding the redundant copy. */
+    uint32_t wearLevelingRows;
+
+    /** The index of the next row in the ring to be verified by
+     * Cy_Em_EEPROM_ScrubStep().
+     */
+    uint32_t scrubRowIndex;
+
+    /** The id of the layout stored in the sequence numbers of the rows
+     * written to the blank nvm: zero, or the id of the new layout if
+     * the context is initialized by Cy_Em_EEPROM_Migrate().
+     */
+    uint32_t layoutId;
+
+    /** The address after the last row of the wear-leveling ring. The ring
+     * starts at userNvmStartAddr.
+     */
+    uint32_t ringEndAddr;
+
+    /** The distance in bytes from a row of the ring to its redundant copy,
+     * the size of the ring.
+     */
+    uint32_t redundantOffset;
+
+    /** log2 of rowSize if it is a power of two, otherwise zero. */
+    uint8_t rowSizeShift;
+
+    /** log2 of byteInRow if it is a power of two, otherwise zero. */
+    uint8_t byteInRowShift;
+
+    /** log2 of numberOfRows if it is a power of two, otherwise zero. */
+    uint8_t numberOfRowsShift;
+
+    /** If not zero, wearLevelingRows is a multiple of numberOfRows, so
+     * the historic data slot of a row depends on its place in the ring only.
+     */
+    uint8_t ringMultipleOfRows;
 
     /**
      * The block storage object holding the information on prototypes for
      * the necessary operations
      */
     const mtb_block_storage_t* bd;
+
+    #if (CY_EM_EEPROM_STATS_ENABLE == 1u) || defined(CY_DOXYGEN)
+    /** The statistics of the Em_EEPROM operations. Use Cy_Em_EEPROM_GetStats()
+     * to read them.
+     */
+    cy_stc_em_eeprom_stats_t stats;
+    #endif /* (CY_EM_EEPROM_STATS_ENABLE == 1u) || defined(CY_DOXYGEN) */
+
+    #if (CY_EM_EEPROM_KV_ENABLE == 1u) || defined(CY_DOXYGEN)
+    /** The key/value store index provided to Cy_Em_EEPROM_KvInit(). */
+    cy_stc_em_eeprom_kv_entry_t* kvIndex;
+
+    /** The number of entries in the key/value store index array. */
+    uint32_t kvIndexSize;
+
+    /** The number of records in the key/value store, including the deleted ones. */
+    uint32_t kvNumRecords;
+
+    /** The logical address after the last record of the key/value store. */
+    uint32_t kvFreeAddr;
+    #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) || defined(CY_DOXYGEN) */
 } cy_stc_eeprom_context_t;
 
+/**
+ * A region of the logical address space of Cy_Em_EEPROM_RegionRead() and
+ * Cy_Em_EEPROM_RegionWrite() stored by its own Em_EEPROM instance. See
+ * \ref section_em_eeprom_regions.
+ */
+typedef struct
+{
+    /** The logical start address of the region. */
+    uint32_t addr;
+
+    /** The size of the region in bytes. */
+    uint32_t size;
+
+    /** The address of the region in the Em_EEPROM storage of the instance. */
+    uint32_t instanceAddr;
+
+    /** The context of the instance initialized by Cy_Em_EEPROM_Init_BD(). */
+    cy_stc_eeprom_context_t* context;
+} cy_stc_em_eeprom_region_t;
+
 
 
 /*******************************************************************************
@@ -1307,6 +1863,39 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Read(
     uint32_t size,
     cy_stc_eeprom_context_t* context);
 
+/** Returns a pointer to the data of a specified location without copying it
+ * when possible. The pointer is returned if the whole range is stored in one
+ * place: in one row in Simple mode, or in the historic data of one row that
+ * is not overridden by any active header when Simple mode is disabled. The
+ * pointer refers to the nvm if \ref CY_EM_EEPROM_NVM_MEMORY_MAPPED is 1 and
+ * to the row read cache otherwise. A pointer to the row read cache is valid
+ * until the next call of any Em_EEPROM function.
+ *
+ * Otherwise, the data is copied to the buffer with Cy_Em_EEPROM_Read() and
+ * the returned pointer refers to the buffer.
+ *
+ * @param[in]       addr       The logical start address in the Em_EEPROM storage to start reading
+ * data from.
+ * @param[in]       size       The amount of data to read in bytes.
+ * @param[out]      buffer     The pointer to a user array of size bytes to copy data to when
+ * the pointer to the storage cannot be returned. May be NULL.
+ * @param[out]      ptr        The pointer to store the pointer to the data to.
+ * @param[in]       context    Pointer to a em_eeprom object
+ *
+ *  @return Result of the read operation.
+ * - CY_RSLT_SUCCESS      - The operation is successfully completed.
+ * - MTB_EM_EEPROM_BAD_CHECKSUM - One of the row the data read from contains bad checksum.
+ * - MTB_EM_EEPROM_REDUNDANT_COPY_USED - Some data were read from redundant copy.
+ * - MTB_EM_EEPROM_BAD_PARAM    - The function input parameter is invalid or the data must be
+ * copied and buffer is NULL.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_ReadPtr(
+    uint32_t addr,
+    uint32_t size,
+    void* buffer,
+    const void** ptr,
+    cy_stc_eeprom_context_t* context);
+
 /**
  * Writes data to a specified location. This function takes the
  * logical Em_EEPROM address and converts it to an actual physical address
@@ -1358,6 +1947,123 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Write(
     uint32_t size,
     cy_stc_eeprom_context_t* context);
 
+/** Writes data to a specified location like Cy_Em_EEPROM_Write(), but only
+ * the bytes that differ from the stored data are written. With Simple mode
+ * disabled, the stored data is read first, and each changed part is written as
+ * a separate header, so a change of a few bytes of a large structure takes one
+ * row write. The changed bytes within headerDataLength bytes are written
+ * together. A write of the unchanged data does not write any row. In Simple
+ * mode, each row is read and compared, including the rows that are
+ * overwritten entirely, and only the changed rows are programmed.
+ *
+ * The additional reads take less time than the row writes saved unless most
+ * of the data changes. As with Cy_Em_EEPROM_Write(), the data of different
+ * rows is not written atomically.
+ *
+ * @param[in] addr        The logical start address in the Em_EEPROM storage to start writing data
+ * to.
+ * @param[in] eepromData  Pointer to the start of the data to be written to Em_EEPROM.
+ * @param[in] size        Total size of the data in bytes.
+ * @param[in] context     Pointer to a em_eeprom object
+ *
+ * @return Result of the write operation.
+ * - CY_RSLT_SUCCESS      - The operation is successfully completed.
+ * - MTB_EM_EEPROM_WRITE_FAIL   - The write operation is failed.
+ * - MTB_EM_EEPROM_BAD_PARAM    - The function input parameter is invalid.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_WriteDelta(
+    uint32_t addr,
+    const void* eepromData,
+    uint32_t size,
+    cy_stc_eeprom_context_t* context);
+
+/** Writes the whole Em_EEPROM content. With Simple mode disabled, the content
+ * takes numberOfRows row writes, the least possible, instead of a row write
+ * for each headerDataLength bytes by Cy_Em_EEPROM_Write().
+ *
+ * The function is intended for factory provisioning. On the host, run it on
+ * a block device in RAM to build the physical nvm image to program together
+ * with the firmware. Cy_Em_EEPROM_Init_BD() uses the image as is. See
+ * the imagebuilder tool in the tools directory.
+ *
+ * The data of different rows is not written atomically. With Simple mode
+ * disabled, after a power loss during the function each byte reads as either
+ * old or new, but the headers of the older rows hide some new bytes only until
+ * the following writes replace the older rows. Write the image again after
+ * a power loss.
+ *
+ * @param[in] eepromData  Pointer to the content of eepromSize bytes.
+ * @param[in] context     Pointer to a em_eeprom object
+ *
+ * @return Result of the write operation.
+ * - CY_RSLT_SUCCESS      - The operation is successfully completed.
+ * - MTB_EM_EEPROM_WRITE_FAIL   - The write operation is failed.
+ * - MTB_EM_EEPROM_BAD_PARAM    - The function input parameter is invalid.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_WriteImage(
+    const void* eepromData,
+    cy_stc_eeprom_context_t* context);
+
+/** Moves the Em_EEPROM content from the layout of the old configuration to
+ * the layout of the new one and initializes the context for the new
+ * configuration as Cy_Em_EEPROM_Init_BD() does. Use it when a firmware update
+ * changes eepromSize, the wear leveling, the redundant copy or
+ * userNvmStartAddr together with them. Simple mode is not supported.
+ *
+ * The content takes numberOfRows row writes of the new configuration, the same
+ * as Cy_Em_EEPROM_WriteImage(), plus the redundant copy. The content beyond
+ * the old eepromSize is zeros. The rows of the old layout are erased after
+ * the last row of the new layout is written, unless the old content has a bad
+ * checksum.
+ *
+ * The function is power-fail safe. The rows of the two layouts are told apart
+ * by the layout id stored in their sequence numbers, so the function finds out
+ * how far the migration went and resumes it. Until it returns
+ * CY_EM_EEPROM_SUCCESS, call it with the same configurations at each startup
+ * instead of Cy_Em_EEPROM_Init_BD() and do not use either configuration
+ * otherwise. Once the migration is complete, the function only checks all rows
+ * of both layouts, so it can be called at each startup.
+ *
+ * The layouts that were never migrated have the layout id zero, so the content
+ * written with newConfig through Cy_Em_EEPROM_Init_BD() is not told apart
+ * from the old layout. Do not write it before the migration. On a blank nvm,
+ * the rows get the id from the first write through the context initialized
+ * by this function.
+ *
+ * The rows of the new layout are placed outside the rows the old layout reads
+ * from, its last numberOfRows written rows and their redundant copies. If
+ * needed, the old rows are moved along their wear-leveling ring first with
+ * writes of the unchanged data. If the new layout overlaps the old one so that
+ * no placement is possible, CY_EM_EEPROM_NO_SPACE is returned and the nvm is
+ * not changed. Place the new layout at a different address or give it
+ * the wear-leveling rows to make the space.
+ *
+ * The id does not depend on userNvmStartAddr, so the configurations must
+ * differ in more than the address. Both start addresses must be a multiple of
+ * the row size apart.
+ *
+ * @param[in]  oldConfig      The configuration the Em_EEPROM was written with.
+ * @param[in]  newConfig      The configuration to move the Em_EEPROM to.
+ * @param[out] context        Pointer to a em_eeprom object, initialized for
+ *                            newConfig.
+ * @param[in]  block_device   The block device of both configurations.
+ *
+ * @return Result of the migration.
+ * - CY_RSLT_SUCCESS      - The migration is complete or not needed.
+ * - CY_EM_EEPROM_BAD_CHECKSUM  - The content of the old layout has a bad
+ *   checksum. The rows of the new layout are written, but the rows of the old
+ *   layout are not erased, so the content can still be read with oldConfig.
+ *   The next call completes the migration with the content written.
+ * - CY_EM_EEPROM_NO_SPACE      - There is no space for the new layout.
+ * - MTB_EM_EEPROM_WRITE_FAIL   - The write operation is failed.
+ * - MTB_EM_EEPROM_BAD_PARAM    - The function input parameter is invalid.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_Migrate(
+    const cy_stc_eeprom_config2_t* oldConfig,
+    const cy_stc_eeprom_config2_t* newConfig,
+    cy_stc_eeprom_context_t* context,
+    mtb_block_storage_t* block_device);
+
 
 /** This function erases the entire content of Em_EEPROM.
  *
@@ -1410,6 +2116,9 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Write(
 cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context);
 
 /** Returns the number of the Em_EEPROM Writes completed so far.
+ *
+ * The number of writes is stored as a 40-bit value. This function returns
+ * its lower 32 bits. Use Cy_Em_EEPROM_NumWrites64() to get the whole value.
  *
  * This function returns zero in the \ref section_em_eeprom_mode_simple since
  * the number of writes is not available in this case.
@@ -1442,6 +2151,281 @@ cy_en_em_eeprom_status_t Cy_Em_EEPROM_Erase(cy_stc_eeprom_context_t* context);
  */
 uint32_t Cy_Em_EEPROM_NumWrites(cy_stc_eeprom_context_t* context);
 
+/** Returns the number of the Em_EEPROM Writes completed so far as the whole
+ * 40-bit value stored in the Em_EEPROM rows.
+ *
+ * Refer to the Cy_Em_EEPROM_NumWrites() function for details.
+ *
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return The number of writes performed to the Em_EEPROM.
+ */
+uint64_t Cy_Em_EEPROM_NumWrites64(cy_stc_eeprom_context_t* context);
+
+/** Reports the number of program/erase cycles of each nvm row of the
+ * wear-leveling ring.
+ *
+ * The rows are written one after another in the ring order, so the number
+ * of cycles of each row is derived from the sequence number of the last
+ * written row and the ring length. Element i of rowWrites corresponds to
+ * the row i of the ring starting from \ref cy_stc_eeprom_context_t.userNvmStartAddr.
+ * The rows of the redundant copy, if enabled, have the same number of cycles
+ * as the corresponding rows of the ring.
+ *
+ * The cycles done by the Cy_Em_EEPROM_Erase() function to clear the rows
+ * are not included.
+ *
+ * The cycles are not available in the \ref section_em_eeprom_mode_simple
+ * since the number of writes is not stored in this case.
+ *
+ * @param[out] rowWrites      Pointer to the array to store the number of cycles
+ * @param[in] numRows         The number of elements in rowWrites. It must be
+ *                            not less than \ref cy_stc_eeprom_context_t.wearLevelingRows
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - The number of cycles is stored in rowWrites.
+ * - CY_EM_EEPROM_BAD_PARAM  - The array is too small, or Simple mode is enabled.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_GetRowWear(uint32_t* rowWrites, uint32_t numRows,
+                                                 cy_stc_eeprom_context_t* context);
+
+/** Estimates the number of row writes left until the most worn nvm row of
+ * the Em_EEPROM reaches the specified number of program/erase cycles.
+ *
+ * The result is in the units of Cy_Em_EEPROM_NumWrites64(). Each
+ * Cy_Em_EEPROM_Write() call writes one row per started
+ * \ref cy_stc_eeprom_context_t.headerDataLength bytes of data. The estimate
+ * uses the number of cycles reported by Cy_Em_EEPROM_GetRowWear() and
+ * the ring order of the next writes.
+ *
+ * @param[in] cycleRating     The write endurance of the nvm in program/erase
+ *                            cycles, taken from the device datasheet
+ * @param[out] remainingWrites Pointer to store the number of row writes left
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - The estimate is stored in remainingWrites.
+ * - CY_EM_EEPROM_BAD_PARAM  - A NULL pointer is passed in, or Simple mode
+ *                             is enabled.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_GetRemainingLife(uint32_t cycleRating,
+                                                       uint64_t* remainingWrites,
+                                                       cy_stc_eeprom_context_t* context);
+
+/** Verifies the checksum of the next rows of the wear-leveling ring and
+ * repairs the rows with a bad checksum from the redundant copy.
+ *
+ * Each call continues from the row where the previous call stopped and
+ * wraps around at the end of the ring, so calling the function from idle
+ * time with a small numRows spreads the verification of the whole Em_EEPROM
+ * over time. If one copy of a row has a bad checksum and the other copy
+ * is good, the bad copy is rewritten. If both copies are good but hold
+ * different writes, the older copy is rewritten with the newer one. After
+ * the repair, reads do not need to fall back to the redundant copy.
+ *
+ * Without the redundant copy, the rows are only verified. A row torn by
+ * a power loss during its write is reported until the row is written again.
+ *
+ * This function is not available in the \ref section_em_eeprom_mode_simple
+ * since the rows have no checksum in this case.
+ *
+ * @param[in] numRows         The maximum number of rows to verify. The rows
+ *                            of the redundant copy are not counted.
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - All verified rows are good.
+ * - CY_EM_EEPROM_REDUNDANT_COPY_USED - One or more rows were repaired.
+ * - CY_EM_EEPROM_BAD_CHECKSUM - One or more rows have a bad checksum and
+ *                             cannot be repaired.
+ * - CY_EM_EEPROM_WRITE_FAIL - The repair of a row failed.
+ * - CY_EM_EEPROM_BAD_PARAM  - A NULL pointer is passed in, or Simple mode
+ *                             is enabled.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_ScrubStep(uint32_t numRows,
+                                                cy_stc_eeprom_context_t* context);
+
+/** Reads data from a specified location of the logical address space made of
+ * regions stored by independent Em_EEPROM instances. Each part of the range is
+ * read with Cy_Em_EEPROM_Read() from the instance storing its region. See
+ * \ref section_em_eeprom_regions.
+ *
+ * @param[in] addr        The logical start address to start reading data from.
+ * @param[out] eepromData Pointer to a user array to write data to.
+ * @param[in] size        Amount of data to read in bytes.
+ * @param[in] regions     The array of the regions.
+ * @param[in] numRegions  The number of the regions in the array.
+ *
+ * @return Result of the read operation.
+ * - CY_EM_EEPROM_SUCCESS    - The operation is successfully completed.
+ * - CY_EM_EEPROM_BAD_CHECKSUM - One of the rows the data read from contains
+ *                             bad checksum.
+ * - CY_EM_EEPROM_REDUNDANT_COPY_USED - Some data were read from redundant copy.
+ * - CY_EM_EEPROM_BAD_PARAM  - A NULL pointer is passed in, or a part of
+ *                             the range is not in any region.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_RegionRead(uint32_t addr, void* eepromData, uint32_t size,
+                                                 const cy_stc_em_eeprom_region_t* regions,
+                                                 uint32_t numRegions);
+
+/** Writes data to a specified location of the logical address space made of
+ * regions stored by independent Em_EEPROM instances. Each part of the range is
+ * written with Cy_Em_EEPROM_Write() to the instance storing its region only,
+ * so the rows of the other instances are not rewritten. The parts of
+ * different regions are not written atomically. See
+ * \ref section_em_eeprom_regions.
+ *
+ * @param[in] addr        The logical start address to start writing data to.
+ * @param[in] eepromData  Pointer to the start of the data to be written.
+ * @param[in] size        Total size of the data in bytes.
+ * @param[in] regions     The array of the regions.
+ * @param[in] numRegions  The number of the regions in the array.
+ *
+ * @return Result of the write operation.
+ * - CY_EM_EEPROM_SUCCESS    - The operation is successfully completed.
+ * - CY_EM_EEPROM_BAD_CHECKSUM - One of the rows the data read from contains
+ *                             bad checksum.
+ * - CY_EM_EEPROM_REDUNDANT_COPY_USED - Some data were read from redundant copy.
+ * - CY_EM_EEPROM_WRITE_FAIL - The write operation is failed. The following
+ *                             regions are not written.
+ * - CY_EM_EEPROM_BAD_PARAM  - A NULL pointer is passed in, or a part of
+ *                             the range is not in any region.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_RegionWrite(uint32_t addr, const void* eepromData,
+                                                  uint32_t size,
+                                                  const cy_stc_em_eeprom_region_t* regions,
+                                                  uint32_t numRegions);
+
+#if (CY_EM_EEPROM_STATS_ENABLE == 1u) || defined(CY_DOXYGEN)
+/** Copies the statistics collected since the Em_EEPROM initialization.
+ *
+ * The statistics show how many logical and nvm operations were done and where
+ * the time of the Em_EEPROM functions goes. The function is available when
+ * \ref CY_EM_EEPROM_STATS_ENABLE is 1. The time fields are collected when
+ * \ref CY_EM_EEPROM_STATS_TIMESTAMP is defined.
+ *
+ * @param[in] context         Pointer to a em_eeprom object
+ * @param[out] stats          Pointer to the structure to store the statistics
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - The statistics are copied.
+ * - CY_EM_EEPROM_BAD_PARAM  - A NULL pointer is passed in.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_GetStats(const cy_stc_eeprom_context_t* context,
+                                               cy_stc_em_eeprom_stats_t* stats);
+#endif /* (CY_EM_EEPROM_STATS_ENABLE == 1u) || defined(CY_DOXYGEN) */
+
+#if (CY_EM_EEPROM_KV_ENABLE == 1u) || defined(CY_DOXYGEN)
+/** Initializes the key/value store. The records are scanned from the start of
+ * the Em_EEPROM storage and the index is built in the provided array. Call
+ * the function after Cy_Em_EEPROM_Init_BD() and again after
+ * Cy_Em_EEPROM_Erase(). Do not write to the Em_EEPROM storage with
+ * Cy_Em_EEPROM_Write() while the key/value store is used.
+ *
+ * If a reset interrupted the change of a value, the function deletes
+ * the previous record of the key, so it may write to nvm.
+ *
+ * @param[out] index          The array for the key/value store index
+ * @param[in] indexSize       The number of entries in the index array. It limits
+ *                            the number of records in the store.
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - The store is initialized.
+ * - CY_EM_EEPROM_REDUNDANT_COPY_USED - Some data were read from redundant copy.
+ * - CY_EM_EEPROM_BAD_CHECKSUM - One of the rows the records were read from
+ *                             contains bad checksum.
+ * - CY_EM_EEPROM_NO_SPACE   - The index array is too small for the stored
+ *                             records. The store is not usable until it is
+ *                             initialized with a larger index array.
+ * - CY_EM_EEPROM_WRITE_FAIL - The deletion of the previous record of a key
+ *                             failed. The index is built, and the deletion
+ *                             is repeated by the next initialization.
+ * - CY_EM_EEPROM_BAD_PARAM  - A NULL pointer or zero indexSize is passed in.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvInit(cy_stc_em_eeprom_kv_entry_t* index,
+                                             uint32_t indexSize,
+                                             cy_stc_eeprom_context_t* context);
+
+/** Stores the value of a key. If the key exists with the same value size of up
+ * to headerDataLength bytes, or in Simple mode, only the value is written.
+ * Otherwise, a new record is written and the previous record of the key is
+ * deleted. If there is no space for the new record, the records are compacted
+ * first. See \ref section_em_eeprom_kv.
+ *
+ * @param[in] key             The key from 1 to CY_EM_EEPROM_KV_KEY_MAX
+ * @param[in] data            The pointer to the value
+ * @param[in] size            The size of the value in bytes from 1 to 0xFFFF
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - The value is stored.
+ * - CY_EM_EEPROM_NO_SPACE   - There is no space for a new record in
+ *                             the storage or in the index after
+ *                             the compaction.
+ * - CY_EM_EEPROM_BAD_CHECKSUM - The compaction stopped at a record read from
+ *                             a row with bad checksum. The record is kept.
+ * - CY_EM_EEPROM_WRITE_FAIL - The write to nvm failed.
+ * - CY_EM_EEPROM_BAD_PARAM  - The function input parameter is invalid.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvSet(uint16_t key, const void* data, uint32_t size,
+                                            cy_stc_eeprom_context_t* context);
+
+/** Reads the value of a key.
+ *
+ * @param[in] key             The key from 1 to CY_EM_EEPROM_KV_KEY_MAX
+ * @param[out] data           The pointer to a user array to write the value to
+ * @param[in,out] size        The size of the user array on input. The size of
+ *                            the value on output.
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - The value is read.
+ * - CY_EM_EEPROM_REDUNDANT_COPY_USED - Some data were read from redundant copy.
+ * - CY_EM_EEPROM_BAD_CHECKSUM - One of the rows the value was read from
+ *                             contains bad checksum.
+ * - CY_EM_EEPROM_KEY_NOT_FOUND - The key is not present.
+ * - CY_EM_EEPROM_BAD_PARAM  - The function input parameter is invalid or
+ *                             the user array is smaller than the value.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvGet(uint16_t key, void* data, uint32_t* size,
+                                            cy_stc_eeprom_context_t* context);
+
+/** Deletes a key. The space of the record is reused by a new record of
+ * the same size, split for a smaller one, or reclaimed by the compaction.
+ *
+ * @param[in] key             The key from 1 to CY_EM_EEPROM_KV_KEY_MAX
+ * @param[in] context         Pointer to a em_eeprom object
+ *
+ * @return Result of the operation.
+ * - CY_EM_EEPROM_SUCCESS    - The key is deleted.
+ * - CY_EM_EEPROM_KEY_NOT_FOUND - The key is not present.
+ * - CY_EM_EEPROM_WRITE_FAIL - The write to nvm failed.
+ * - CY_EM_EEPROM_BAD_PARAM  - The function input parameter is invalid.
+ */
+cy_en_em_eeprom_status_t Cy_Em_EEPROM_KvDelete(uint16_t key, cy_stc_eeprom_context_t* context);
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) || defined(CY_DOXYGEN) */
+
+#if (CY_EM_EEPROM_TRACE_ENABLE == 1u) || defined(CY_DOXYGEN)
+/** Reports a completed block device operation. The function is not part of
+ * the library. It must be implemented by the application when
+ * \ref CY_EM_EEPROM_TRACE_ENABLE is 1.
+ *
+ * The function is called from the Em_EEPROM functions after each call of
+ * the block device read, program, erase, program_nb and erase_nb functions.
+ * Keep it short as it adds to the duration of the Em_EEPROM operations.
+ *
+ * @param[in] op              The block device operation
+ * @param[in] addr            The block device address of the operation
+ * @param[in] length          The number of bytes read, programmed or erased
+ * @param[in] duration        The duration of the operation in the units of
+ *                            \ref CY_EM_EEPROM_STATS_TIMESTAMP
+ */
+void Cy_Em_EEPROM_TraceHook(cy_en_em_eeprom_trace_op_t op, uint32_t addr, uint32_t length,
+                            uint32_t duration);
+#endif /* (CY_EM_EEPROM_TRACE_ENABLE == 1u) || defined(CY_DOXYGEN) */
+
 
 /** \} group_emeeprom */
 
@@ -1466,6 +2450,44 @@ uint32_t Cy_Em_EEPROM_NumWrites(cy_stc_eeprom_context_t* context);
 #define CY_EM_EEPROM_HEADER_LEN_OFFSET_U32          (3u)
 #define CY_EM_EEPROM_HEADER_DATA_OFFSET_U32         (4u)
 
+/* The checksum occupies the lower byte of the checksum word. The upper three
+ * bytes hold bits 32..55 of the sequence number. These bytes are zero in rows
+ * written by versions before 2.50, so such rows are read without conversion.
+ * They are never all ones, so a row erased to ones is not taken for a written
+ * row even if it passes the CRC-8 check.
+ */
+#define CY_EM_EEPROM_HEADER_CHECKSUM_MASK           (0xFFu)
+#define CY_EM_EEPROM_HEADER_SEQ_NUM_HIGH_POS        (8u)
+#define CY_EM_EEPROM_SEQ_NUM_HIGH_MASK              (0xFFFFFFu)
+
+/* The sequence number is the 40-bit counter of the writes and, above it,
+ * the 16-bit id of the layout the row belongs to. The rows written by
+ * Cy_Em_EEPROM_Migrate() get the odd id of the new configuration, below
+ * CY_EM_EEPROM_LAYOUT_ID_MASK, the later rows keep the id of the last written
+ * row. The id is zero in the layouts
+ * that were never migrated, as in rows written by versions before 2.50.
+ */
+#define CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK           (0xFFFFFFFFFFuLL)
+#define CY_EM_EEPROM_SEQ_NUM_LAYOUT_POS             (40u)
+#define CY_EM_EEPROM_LAYOUT_ID_MASK                 (0xFFFFu)
+
+/* The FNV-1a hash of the layout parameters */
+#define CY_EM_EEPROM_LAYOUT_HASH_BASIS              (2166136261u)
+#define CY_EM_EEPROM_LAYOUT_HASH_PRIME              (16777619u)
+
+/* The upper bit of the header length word marks the run-length encoded header
+ * data. The rest of the word is the length of the expanded data.
+ */
+#define CY_EM_EEPROM_HEADER_LEN_COMPRESSED          (0x80000000u)
+#define CY_EM_EEPROM_HEADER_LEN_MASK                (0x7FFFFFFFu)
+
+/* The run-length encoding of the header data */
+#define CY_EM_EEPROM_RLE_RUN_FLAG                   (0x80u)
+#define CY_EM_EEPROM_RLE_RUN_BIAS                   (125u)
+#define CY_EM_EEPROM_RLE_MIN_RUN                    (3u)
+#define CY_EM_EEPROM_RLE_MAX_RUN                    (130u)
+#define CY_EM_EEPROM_RLE_MAX_LITERAL                (128u)
+
 /* The same offsets as above used for direct memory addressing. */
 #define CY_EM_EEPROM_HEADER_CHECKSUM_OFFSET         (0u)
 #define CY_EM_EEPROM_HEADER_ADDR_OFFSET             (8u)
@@ -1475,7 +2497,7 @@ uint32_t Cy_Em_EEPROM_NumWrites(cy_stc_eeprom_context_t* context);
 #define CY_EM_EEPROM_U32                            (4u)
 
 /* The maximum wear-leveling value. */
-#define CY_EM_EEPROM_MAX_WEAR_LEVELING_FACTOR       (10u)
+#define CY_EM_EEPROM_MAX_WEAR_LEVELING_FACTOR       (255u)
 
 /* The maximum allowed nvm row Write/Erase operation duration. */
 #define CY_EM_EEPROM_MAX_WRITE_DURATION_MS          (50u)
@@ -1488,6 +2510,52 @@ uint32_t Cy_Em_EEPROM_NumWrites(cy_stc_eeprom_context_t* context);
 #define CY_EM_EEPROM_MAXIMUM_ROW_SIZE               (0x200)
 #endif
 
+/** The number of nvm rows kept in the row read cache. Each entry takes
+ * CY_EM_EEPROM_MAXIMUM_ROW_SIZE bytes of RAM. Define it before including this
+ * file to read each row at most once per Em_EEPROM operation on storage with
+ * expensive reads. See \ref section_em_eeprom_row_cache.
+ */
+#if !defined(CY_EM_EEPROM_ROW_CACHE_ENTRIES)
+#define CY_EM_EEPROM_ROW_CACHE_ENTRIES              (1u)
+#endif
+
+#if (CY_EM_EEPROM_ROW_CACHE_ENTRIES < 1u)
+#error "CY_EM_EEPROM_ROW_CACHE_ENTRIES must be at least 1"
+#endif
+
+/** The largest read in bytes that stops at the newest active headers holding
+ * the data. The reads take one bit of RAM per byte of this size. Define it to
+ * 0 to apply all active headers in each read. See
+ * \ref section_em_eeprom_row_cache.
+ */
+#if !defined(CY_EM_EEPROM_READ_BITMAP_SIZE)
+#define CY_EM_EEPROM_READ_BITMAP_SIZE               (256u)
+#endif
+
+#if (CY_EM_EEPROM_FIXED_GEOMETRY == 1u)
+#if !defined(CY_EM_EEPROM_FIXED_ROW_SIZE) || !defined(CY_EM_EEPROM_FIXED_EEPROM_SIZE) || \
+    !defined(CY_EM_EEPROM_FIXED_WEAR_LEVELING_ROWS)
+#error "CY_EM_EEPROM_FIXED_GEOMETRY requires the fixed row size, Em_EEPROM size and ring rows"
+#endif
+/* The number of rows of the Em_EEPROM data with the fixed geometry */
+#define CY_EM_EEPROM_FIXED_NUMBER_OF_ROWS           \
+    ((((CY_EM_EEPROM_FIXED_EEPROM_SIZE) - 1u) / ((CY_EM_EEPROM_FIXED_ROW_SIZE) / 2u)) + 1u)
+#endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 1u) */
+
+/* The key/value store record: the key and the value size as little-endian
+ * 16-bit values followed by the value. The key of an erased record is zero,
+ * so it ends the list of records.
+ */
+#define CY_EM_EEPROM_KV_RECORD_HEADER_SIZE          (4u)
+#define CY_EM_EEPROM_KV_KEY_END                     (0x0000u)
+/** The key of a deleted key/value store record. */
+#define CY_EM_EEPROM_KV_KEY_DELETED                 (0xFFFFu)
+/** The largest key of the key/value store. */
+#define CY_EM_EEPROM_KV_KEY_MAX                     (0xFFFEu)
+#define CY_EM_EEPROM_KV_SIZE_MAX                    (0xFFFFu)
+/* The size of the stack buffer the compaction copies the records by */
+#define CY_EM_EEPROM_KV_COPY_SIZE                   (64u)
+
 
 /* BACK COMPATIBILITY MACROS AND DEFINES START
  * These defines are device dependent and kept for backward compatibility.
@@ -1545,6 +2613,11 @@ uint32_t Cy_Em_EEPROM_NumWrites(cy_stc_eeprom_context_t* context);
                 (CY_EM_EEPROM_GET_NUM_DATA(dataSize, simpleMode) * \
                 ((((1uL - (simpleMode)) * (wearLeveling)) * ((redundantCopy) + 1uL)) + (simpleMode)))
 
+/** Returns the size of flash allocated for Em_EEPROM when the wear-leveling ring length
+   is specified in rows */
+#define CY_EM_EEPROM_GET_PHYSICAL_SIZE_WL_ROWS(wearLevelingRows, redundantCopy) \
+                ((wearLevelingRows) * CY_EM_EEPROM_FLASH_SIZEOF_ROW * ((redundantCopy) + 1uL))
+
 /* BACK COMPATIBILITY MACROS AND DEFINES END
  */
 
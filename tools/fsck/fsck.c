@@ -0,0 +1,643 @@
+/***************************************************************************//**
+* \file fsck.c
+*
+* \brief
+*  Offline inspector of Emulated EEPROM nvm dumps.
+*
+*  The inspector decodes binary dumps of the Em_EEPROM nvm, for example read
+*  from returned units. It includes the library source, so the rows are
+*  parsed by the same functions the device uses: GetStoredSeqNum(),
+*  CheckRowChecksum(), IsRowErased() and DefineLastWrittenRow(). For each dump
+*  it reports:
+*  * The ring head: the last written row, its number of writes and layout id.
+*  * The state of each row of the ring: erased, valid or with a bad checksum,
+*    with the number of writes, the layout id and the header of the valid rows.
+*  * The rows where the redundant copy differs from the main copy.
+*  * The logical Em_EEPROM content, reconstructed by Cy_Em_EEPROM_Read() on
+*    a copy-on-write mapping of the dump, and the read status.
+*
+*  A summary line is printed for each dump. With the -o option, the row report
+*  and the logical content are saved to the specified directory as
+*  <dump name>.txt and <dump name>.bin.
+*
+*  The dumps are memory-mapped with the file block device of the host tools,
+*  so they are not loaded into RAM and are never altered.
+*
+*  Dumps are checked in parallel by worker processes, one per CPU by default.
+*  The library keeps the row cache and the RAM buffer at file scope, so each
+*  worker is a process rather than a thread. The summary lines are printed in
+*  the order of the dumps after all workers finish.
+*
+*  The exit code is non-zero if any dump is not clean.
+*
+*  Usage: fsck [options] <dump file or directory>...
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "mtb_block_storage_file.h"
+
+/* The library source provides the static row parsing functions */
+#include "cy_em_eeprom.c"
+
+/*******************************************************************************
+* Dump inspection
+*******************************************************************************/
+/* Any non-zero address, the dump does not depend on it */
+#define FSCK_BASE_ADDR                  (0x10000000u)
+
+#define FSCK_SUMMARY_SIZE               (256u)
+#define FSCK_PATH_SIZE                  (1024u)
+
+typedef enum
+{
+    FSCK_PENDING = 0u,
+    FSCK_CLEAN,
+    FSCK_DEGRADED,
+    FSCK_CORRUPT,
+    FSCK_ERROR,
+    FSCK_NUM_VERDICTS
+} fsck_verdict_t;
+
+typedef enum
+{
+    FSCK_ROW_ERASED = 0u,
+    FSCK_ROW_VALID,
+    FSCK_ROW_BAD
+} fsck_row_state_t;
+
+/* The result of a dump, written by a worker to the memory shared with the parent */
+typedef struct
+{
+    char summary[FSCK_SUMMARY_SIZE];
+    uint32_t verdict;
+} fsck_result_t;
+
+typedef struct
+{
+    /* The index of the next dump to check */
+    uint32_t next;
+    fsck_result_t result[];
+} fsck_shared_t;
+
+static const char* const verdictNames[FSCK_NUM_VERDICTS] =
+{
+    "worker failed", "clean", "degraded", "corrupt", "error"
+};
+static const char* const rowStateNames[] = { "erased", "valid", "bad crc" };
+
+static mtb_block_storage_t probeBd;
+static uint32_t programSize;
+static cy_stc_eeprom_config2_t fsckConfig;
+static uint32_t physicalSize;
+static uint32_t dumpOffset;
+static const char* outDir;
+
+
+/*******************************************************************************
+* Function Name: ProbeIsInRange
+****************************************************************************//**
+*
+* The probe block device validates the configuration with
+* Cy_Em_EEPROM_Init_BD() and records the physical size of the dumps. It reads
+* as erased.
+*
+*******************************************************************************/
+static bool ProbeIsInRange(void* context, uint32_t addr, uint32_t length)
+{
+    (void)context;
+    physicalSize = length;
+    return (FSCK_BASE_ADDR == addr);
+}
+
+
+static cy_rslt_t ProbeRead(void* context, uint32_t addr, uint32_t length, uint8_t* buf)
+{
+    (void)context;
+    (void)addr;
+    (void)memset(buf, 0, length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+static uint32_t ProbeGetProgramSize(void* context, uint32_t addr)
+{
+    (void)context;
+    (void)addr;
+    return programSize;
+}
+
+
+/* Implemented for Cy_Em_EEPROM_Init(), which is not used by the inspector */
+cy_rslt_t mtb_block_storage_nvm_create(mtb_block_storage_t* bsd)
+{
+    *bsd = probeBd;
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: Usage
+****************************************************************************//**
+*
+* Prints the command line options.
+*
+*******************************************************************************/
+static void Usage(void)
+{
+    printf("Usage: fsck [options] <dump file or directory>...\n"
+           "  -s <size>     Em_EEPROM size in bytes, required\n"
+           "  -p <size>     nvm program size in bytes, 512 by default\n"
+           "  -m            Simple mode\n"
+           "  -w <factor>   wear-leveling factor, 1 by default\n"
+           "  -n <rows>     wear-leveling ring length in rows, overrides -w\n"
+           "  -r            redundant copy\n"
+           "  -a <offset>   offset of the Em_EEPROM in the dumps, a multiple of the program\n"
+           "                size, 0 by default\n"
+           "  -j <jobs>     number of worker processes, the number of CPUs by default\n"
+           "  -o <dir>      directory for the row reports and the logical content\n"
+           "The regular files of a directory are checked in the order of their names.\n");
+}
+
+
+/*******************************************************************************
+* Function Name: OpenOutput
+****************************************************************************//**
+*
+* Opens the output file of the dump in the output directory, if specified.
+*
+*******************************************************************************/
+static FILE* OpenOutput(const char* path, const char* suffix, const char* mode)
+{
+    char name[FSCK_PATH_SIZE];
+    const char* baseName = strrchr(path, '/');
+    FILE* file = NULL;
+
+    baseName = (NULL != baseName) ? (baseName + 1) : path;
+    if ((NULL != outDir) &&
+        (sizeof(name) > (size_t)snprintf(name, sizeof(name), "%s/%s%s", outDir, baseName, suffix)))
+    {
+        file = fopen(name, mode);
+    }
+    return file;
+}
+
+
+/*******************************************************************************
+* Function Name: GetRowState
+****************************************************************************//**
+*
+* Returns the state of the row the way the library sees it.
+*
+*******************************************************************************/
+static fsck_row_state_t GetRowState(const uint32_t* ptrRow, uint32_t rowSize)
+{
+    fsck_row_state_t state = FSCK_ROW_BAD;
+
+    if (IsRowErased(ptrRow))
+    {
+        state = FSCK_ROW_ERASED;
+    }
+    else if (CY_EM_EEPROM_SUCCESS == CheckRowChecksum(ptrRow, rowSize))
+    {
+        state = FSCK_ROW_VALID;
+    }
+    else
+    {
+        /* The row is torn or corrupted */
+    }
+    return state;
+}
+
+
+/*******************************************************************************
+* Function Name: PrintRow
+****************************************************************************//**
+*
+* Prints the state of the row to the report. The valid rows are printed with
+* the sequence number and the header.
+*
+*******************************************************************************/
+static void PrintRow(FILE* report, const uint32_t* ptrRow, fsck_row_state_t state)
+{
+    if (NULL != report)
+    {
+        fprintf(report, "%s", rowStateNames[state]);
+        if (FSCK_ROW_VALID == state)
+        {
+            uint32_t headerLen = ptrRow[CY_EM_EEPROM_HEADER_LEN_OFFSET_U32];
+
+            fprintf(report, "   seq %10llu layout %04x header %4u bytes at %5u%s",
+                    (unsigned long long)(GetStoredSeqNum(ptrRow) &
+                                         CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK),
+                    (unsigned)(GetStoredSeqNum(ptrRow) >> CY_EM_EEPROM_SEQ_NUM_LAYOUT_POS),
+                    (unsigned)(headerLen & CY_EM_EEPROM_HEADER_LEN_MASK),
+                    (unsigned)ptrRow[CY_EM_EEPROM_HEADER_ADDR_OFFSET_U32],
+                    (0u != (headerLen & CY_EM_EEPROM_HEADER_LEN_COMPRESSED)) ? " rle" : "");
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: CheckDump
+****************************************************************************//**
+*
+* Checks one dump and stores the summary and the verdict to the result.
+*
+*******************************************************************************/
+static void CheckDump(const char* path, fsck_result_t* result)
+{
+    mtb_block_storage_file_config_t fileConfig =
+    {
+        .path = path,
+        .offset = dumpOffset,
+        .baseAddr = FSCK_BASE_ADDR,
+        .programSize = programSize,
+        .copyOnWrite = true
+    };
+    mtb_block_storage_file_t file;
+    mtb_block_storage_t fileBd;
+    cy_stc_eeprom_context_t context;
+    cy_en_em_eeprom_status_t headResult;
+    cy_en_em_eeprom_status_t readResult;
+    uint32_t counts[2u][3u] = { { 0u } };
+    uint32_t numDiverged = 0u;
+    uint32_t headIndex = 0u;
+    uint64_t headSeqNum = 0u;
+    const uint32_t* rows = NULL;
+    uint8_t* image = NULL;
+    FILE* report = NULL;
+    FILE* imageFile;
+    uint32_t verdict = FSCK_ERROR;
+    cy_rslt_t fileResult = mtb_block_storage_file_create(&fileBd, &file, &fileConfig);
+    uint32_t i;
+
+    if (CY_RSLT_SUCCESS != fileResult)
+    {
+        (void)snprintf(result->summary, FSCK_SUMMARY_SIZE, "cannot map the file: 0x%08x",
+                       (unsigned)fileResult);
+    }
+    else if (file.size < physicalSize)
+    {
+        (void)snprintf(result->summary, FSCK_SUMMARY_SIZE,
+                       "%u bytes at offset %u, %u bytes expected",
+                       (unsigned)file.size, (unsigned)dumpOffset, (unsigned)physicalSize);
+    }
+    else
+    {
+        image = malloc(fsckConfig.eepromSize);
+        if (NULL == image)
+        {
+            (void)snprintf(result->summary, FSCK_SUMMARY_SIZE, "out of memory");
+        }
+    }
+
+    if (NULL != image)
+    {
+        /* The rows are parsed in the mapping before the read may repair them */
+        rows = (const uint32_t*)file.mem;
+        (void)Cy_Em_EEPROM_Init_BD(&fsckConfig, &context, &fileBd);
+        headResult = DefineLastWrittenRow(&context);
+        headIndex = (context.lastWrittenRowAddr - FSCK_BASE_ADDR) / context.rowSize;
+
+        report = OpenOutput(path, ".txt", "w");
+        if (NULL != report)
+        {
+            fprintf(report, "%s\nrows of %u bytes, %u rows of data, ring of %u rows%s%s\n\n",
+                    path, (unsigned)context.rowSize, (unsigned)context.numberOfRows,
+                    (unsigned)context.wearLevelingRows,
+                    (0u != context.redundantCopy) ? ", redundant copy" : "",
+                    (0u != context.simpleMode) ? ", Simple mode" : "");
+        }
+
+        /* Simple mode rows hold the data only */
+        for (i = 0u; (0u == context.simpleMode) && (i < context.wearLevelingRows); i++)
+        {
+            const uint32_t* ptrRow = &rows[(i * context.rowSize) / CY_EM_EEPROM_U32];
+            fsck_row_state_t state = GetRowState(ptrRow, context.rowSize);
+
+            counts[0u][state]++;
+            if ((FSCK_ROW_VALID == state) && (GetStoredSeqNum(ptrRow) > headSeqNum))
+            {
+                headSeqNum = GetStoredSeqNum(ptrRow);
+            }
+            if (NULL != report)
+            {
+                fprintf(report, "row %4u  ", (unsigned)i);
+                PrintRow(report, ptrRow, state);
+                fprintf(report, "%s\n", (i == headIndex) ? " <- head" : "");
+            }
+
+            if (0u != context.redundantCopy)
+            {
+                const uint32_t* ptrCopy =
+                    &ptrRow[(context.wearLevelingRows * context.rowSize) / CY_EM_EEPROM_U32];
+                fsck_row_state_t copyState = GetRowState(ptrCopy, context.rowSize);
+
+                counts[1u][copyState]++;
+                if ((FSCK_ROW_VALID == copyState) && (GetStoredSeqNum(ptrCopy) > headSeqNum))
+                {
+                    headSeqNum = GetStoredSeqNum(ptrCopy);
+                }
+                if (0 == memcmp(ptrRow, ptrCopy, context.rowSize))
+                {
+                    if (NULL != report)
+                    {
+                        fprintf(report, "          redundant same\n");
+                    }
+                }
+                else
+                {
+                    numDiverged++;
+                    if (NULL != report)
+                    {
+                        fprintf(report, "          redundant ");
+                        PrintRow(report, ptrCopy, copyState);
+                        fprintf(report, " diverged\n");
+                    }
+                }
+            }
+        }
+
+        readResult = Cy_Em_EEPROM_Read(0u, image, fsckConfig.eepromSize, &context);
+
+        imageFile = OpenOutput(path, ".bin", "wb");
+        if (NULL != imageFile)
+        {
+            (void)fwrite(image, 1u, fsckConfig.eepromSize, imageFile);
+            (void)fclose(imageFile);
+        }
+
+        if ((CY_EM_EEPROM_SUCCESS != readResult) &&
+            (CY_EM_EEPROM_REDUNDANT_COPY_USED != readResult))
+        {
+            verdict = FSCK_CORRUPT;
+        }
+        else if ((CY_EM_EEPROM_SUCCESS != readResult) ||
+                 (CY_EM_EEPROM_SUCCESS != headResult) || (0u != numDiverged) ||
+                 (0u != counts[0u][FSCK_ROW_BAD]) || (0u != counts[1u][FSCK_ROW_BAD]))
+        {
+            verdict = FSCK_DEGRADED;
+        }
+        else
+        {
+            verdict = FSCK_CLEAN;
+        }
+
+        if (0u != context.simpleMode)
+        {
+            (void)snprintf(result->summary, FSCK_SUMMARY_SIZE, "Simple mode, read 0x%08x",
+                           (unsigned)readResult);
+        }
+        else
+        {
+            (void)snprintf(result->summary, FSCK_SUMMARY_SIZE,
+                           "head row %u seq %llu layout %04x%s, rows %u valid %u erased %u bad, "
+                           "redundant %u bad %u diverged, read 0x%08x",
+                           (unsigned)headIndex,
+                           (unsigned long long)(headSeqNum & CY_EM_EEPROM_SEQ_NUM_COUNTER_MASK),
+                           (unsigned)(headSeqNum >> CY_EM_EEPROM_SEQ_NUM_LAYOUT_POS),
+                           (CY_EM_EEPROM_REDUNDANT_COPY_USED == headResult) ? " (redundant)" : "",
+                           (unsigned)counts[0u][FSCK_ROW_VALID],
+                           (unsigned)counts[0u][FSCK_ROW_ERASED],
+                           (unsigned)counts[0u][FSCK_ROW_BAD], (unsigned)counts[1u][FSCK_ROW_BAD],
+                           (unsigned)numDiverged, (unsigned)readResult);
+        }
+        if (NULL != report)
+        {
+            fprintf(report, "\n%s: %s\n", verdictNames[verdict], result->summary);
+            (void)fclose(report);
+        }
+    }
+
+    result->verdict = verdict;
+    free(image);
+    (void)mtb_block_storage_file_free(&file);
+}
+
+
+/* Orders the dump paths by name */
+static int ComparePaths(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+
+/*******************************************************************************
+* Function Name: AddPath
+****************************************************************************//**
+*
+* Adds the dump file to the list, or the regular files of the directory in
+* the order of their names.
+*
+*******************************************************************************/
+
+static bool AddPath(const char* path, char*** paths, uint32_t* numPaths)
+{
+    struct stat info;
+    bool result = (0 == stat(path, &info));
+    uint32_t first = *numPaths;
+
+    if (result && S_ISDIR(info.st_mode))
+    {
+        DIR* dir = opendir(path);
+        struct dirent* entry;
+
+        result = (NULL != dir);
+        while (result && (NULL != (entry = readdir(dir))))
+        {
+            char name[FSCK_PATH_SIZE];
+
+            if (('.' != entry->d_name[0]) &&
+                (sizeof(name) > (size_t)snprintf(name, sizeof(name), "%s/%s", path,
+                                                 entry->d_name)) &&
+                (0 == stat(name, &info)) && S_ISREG(info.st_mode))
+            {
+                result = AddPath(name, paths, numPaths);
+            }
+        }
+        if (NULL != dir)
+        {
+            (void)closedir(dir);
+        }
+        qsort(&(*paths)[first], *numPaths - first, sizeof(char*), ComparePaths);
+    }
+    else if (result)
+    {
+        *paths = realloc(*paths, (*numPaths + 1u) * sizeof(char*));
+        result = (NULL != *paths);
+        if (result)
+        {
+            (*paths)[*numPaths] = strdup(path);
+            result = (NULL != (*paths)[*numPaths]);
+            (*numPaths)++;
+        }
+    }
+    else
+    {
+        printf("Cannot open %s\n", path);
+    }
+    return result;
+}
+
+
+int main(int argc, char** argv)
+{
+    cy_stc_eeprom_context_t context;
+    fsck_shared_t* shared;
+    char** paths = NULL;
+    uint32_t numPaths = 0u;
+    uint32_t counts[FSCK_NUM_VERDICTS] = { 0u };
+    long numJobs = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t sharedSize;
+    uint32_t i;
+    int argIndex;
+
+    (void)memset(&fsckConfig, 0, sizeof(fsckConfig));
+    fsckConfig.wearLevelingFactor = 1u;
+    fsckConfig.blockingWrite = 1u;
+    fsckConfig.userNvmStartAddr = FSCK_BASE_ADDR;
+    programSize = 512u;
+
+    for (argIndex = 1; argIndex < argc; argIndex++)
+    {
+        const char* arg = argv[argIndex];
+        bool hasValue = ((argIndex + 1) < argc);
+
+        if ((0 == strcmp(arg, "-s")) && hasValue)
+        {
+            fsckConfig.eepromSize = (uint32_t)strtoul(argv[++argIndex], NULL, 0);
+        }
+        else if ((0 == strcmp(arg, "-p")) && hasValue)
+        {
+            programSize = (uint32_t)strtoul(argv[++argIndex], NULL, 0);
+        }
+        else if (0 == strcmp(arg, "-m"))
+        {
+            fsckConfig.simpleMode = 1u;
+        }
+        else if ((0 == strcmp(arg, "-w")) && hasValue)
+        {
+            fsckConfig.wearLevelingFactor = (uint8_t)strtoul(argv[++argIndex], NULL, 0);
+        }
+        else if ((0 == strcmp(arg, "-n")) && hasValue)
+        {
+            fsckConfig.wearLevelingRows = (uint32_t)strtoul(argv[++argIndex], NULL, 0);
+        }
+        else if (0 == strcmp(arg, "-r"))
+        {
+            fsckConfig.redundantCopy = 1u;
+        }
+        else if ((0 == strcmp(arg, "-a")) && hasValue)
+        {
+            dumpOffset = (uint32_t)strtoul(argv[++argIndex], NULL, 0);
+        }
+        else if ((0 == strcmp(arg, "-j")) && hasValue)
+        {
+            numJobs = strtol(argv[++argIndex], NULL, 0);
+        }
+        else if ((0 == strcmp(arg, "-o")) && hasValue)
+        {
+            outDir = argv[++argIndex];
+        }
+        else if ('-' != arg[0])
+        {
+            if (!AddPath(arg, &paths, &numPaths))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            Usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (0u != fsckConfig.wearLevelingRows)
+    {
+        /* The ring length in rows is used only with the factor set to zero */
+        fsckConfig.wearLevelingFactor = 0u;
+    }
+    if ((0u == numPaths) || (0u == fsckConfig.eepromSize) || (0u == programSize) ||
+        (0u != (programSize % CY_EM_EEPROM_U32)) || (0u != (dumpOffset % programSize)))
+    {
+        Usage();
+        return EXIT_FAILURE;
+    }
+
+    probeBd.read = ProbeRead;
+    probeBd.get_read_size = ProbeGetProgramSize;
+    probeBd.get_program_size = ProbeGetProgramSize;
+    probeBd.get_erase_size = ProbeGetProgramSize;
+    probeBd.is_in_range = ProbeIsInRange;
+    probeBd.is_erase_required = true;
+
+    /* Validates the configuration and gets the physical size of the dumps */
+    if (CY_EM_EEPROM_SUCCESS != Cy_Em_EEPROM_Init_BD(&fsckConfig, &context, &probeBd))
+    {
+        printf("The configuration is not valid\n");
+        return EXIT_FAILURE;
+    }
+
+    sharedSize = sizeof(fsck_shared_t) + (numPaths * sizeof(fsck_result_t));
+    shared = mmap(NULL, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == shared)
+    {
+        printf("Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    numJobs = ((1L <= numJobs) && (numJobs < (long)numPaths)) ? numJobs : (long)numPaths;
+
+    /* Each worker takes the next unchecked dump until none is left */
+    (void)fflush(stdout);
+    for (i = 0u; i < (uint32_t)numJobs; i++)
+    {
+        if (0 == fork())
+        {
+            uint32_t index;
+
+            while ((index = __atomic_fetch_add(&shared->next, 1u, __ATOMIC_RELAXED)) < numPaths)
+            {
+                CheckDump(paths[index], &shared->result[index]);
+            }
+            _exit(EXIT_SUCCESS);
+        }
+    }
+    while (0 < wait(NULL))
+    {
+        /* Waits for all workers */
+    }
+
+    for (i = 0u; i < numPaths; i++)
+    {
+        uint32_t verdict = shared->result[i].verdict;
+
+        counts[verdict]++;
+        printf("%s: %s, %s\n", paths[i], verdictNames[verdict], shared->result[i].summary);
+        free(paths[i]);
+    }
+    printf("%u dumps: %u clean, %u degraded, %u corrupt, %u errors\n", (unsigned)numPaths,
+           (unsigned)counts[FSCK_CLEAN], (unsigned)counts[FSCK_DEGRADED],
+           (unsigned)counts[FSCK_CORRUPT], (unsigned)(counts[FSCK_ERROR] + counts[FSCK_PENDING]));
+
+    free(paths);
+    (void)munmap(shared, sharedSize);
+    return (counts[FSCK_CLEAN] == numPaths) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
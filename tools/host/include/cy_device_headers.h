@@ -0,0 +1,23 @@
+/***************************************************************************//**
+* \file cy_device_headers.h
+*
+* \brief
+*  Host build replacement of the device header for the Em_EEPROM host tools.
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#if !defined(CY_DEVICE_HEADERS_H)
+#define CY_DEVICE_HEADERS_H
+
+#if !defined(CY_FLASH_SIZEOF_ROW)
+#define CY_FLASH_SIZEOF_ROW                 (512u)
+#endif
+
+#endif /* CY_DEVICE_HEADERS_H */
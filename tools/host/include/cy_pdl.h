@@ -0,0 +1,23 @@
+/***************************************************************************//**
+* \file cy_pdl.h
+*
+* \brief
+*  Host build replacement of the peripheral driver library header for
+*  the Em_EEPROM host tools.
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#if !defined(CY_PDL_H)
+#define CY_PDL_H
+
+#include "cy_device_headers.h"
+#include "cy_syslib.h"
+
+#endif /* CY_PDL_H */
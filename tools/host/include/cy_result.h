@@ -0,0 +1,36 @@
+/***************************************************************************//**
+* \file cy_result.h
+*
+* \brief
+*  Host build replacement of the result type header for the Em_EEPROM
+*  host tools.
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#if !defined(CY_RESULT_H)
+#define CY_RESULT_H
+
+#include <stdint.h>
+
+typedef uint32_t cy_rslt_t;
+
+#define CY_RSLT_SUCCESS                         ((cy_rslt_t)0x00000000U)
+
+#define CY_RSLT_TYPE_INFO                       (0U)
+#define CY_RSLT_TYPE_WARNING                    (1U)
+#define CY_RSLT_TYPE_ERROR                      (2U)
+#define CY_RSLT_TYPE_FATAL                      (3U)
+
+#define CY_RSLT_MODULE_MIDDLEWARE_EM_EEPROM     (0x1A0U)
+
+#define CY_RSLT_CREATE(type, module, code) \
+    ((((module) & 0x3FFFU) << 18U) | (((code) & 0xFFFFU) << 0U) | (((type) & 0x3U) << 16U))
+
+#endif /* CY_RESULT_H */
@@ -0,0 +1,23 @@
+/***************************************************************************//**
+* \file cy_syslib.h
+*
+* \brief
+*  Host build replacement of the system library header for the Em_EEPROM
+*  host tools.
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#if !defined(CY_SYSLIB_H)
+#define CY_SYSLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* CY_SYSLIB_H */
@@ -0,0 +1,55 @@
+/***************************************************************************//**
+* \file mtb_block_storage.h
+*
+* \brief
+*  Host build replacement of the block storage interface for the Em_EEPROM
+*  host tools. Only the interface is provided, the block devices are
+*  implemented by the tools.
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#if !defined(MTB_BLOCK_STORAGE_H)
+#define MTB_BLOCK_STORAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+#define MTB_BLOCK_STORAGE_NON_BLOCKING_SUPPORTED
+
+typedef cy_rslt_t (* mtb_block_storage_read_t)(void* context, uint32_t addr, uint32_t length,
+                                               uint8_t* buf);
+typedef cy_rslt_t (* mtb_block_storage_program_t)(void* context, uint32_t addr, uint32_t length,
+                                                  const uint8_t* buf);
+typedef cy_rslt_t (* mtb_block_storage_erase_t)(void* context, uint32_t addr, uint32_t length);
+typedef uint32_t (* mtb_block_storage_read_size_t)(void* context, uint32_t addr);
+typedef uint32_t (* mtb_block_storage_program_size_t)(void* context, uint32_t addr);
+typedef uint32_t (* mtb_block_storage_erase_size_t)(void* context, uint32_t addr);
+typedef bool (* mtb_block_storage_is_in_range_t)(void* context, uint32_t addr, uint32_t length);
+
+typedef struct
+{
+    mtb_block_storage_read_t read;
+    mtb_block_storage_program_t program;
+    mtb_block_storage_erase_t erase;
+    mtb_block_storage_program_t program_nb;
+    mtb_block_storage_erase_t erase_nb;
+    mtb_block_storage_read_size_t get_read_size;
+    mtb_block_storage_program_size_t get_program_size;
+    mtb_block_storage_erase_size_t get_erase_size;
+    mtb_block_storage_is_in_range_t is_in_range;
+    bool is_erase_required;
+    void* context;
+} mtb_block_storage_t;
+
+/* Implemented by the host tool that uses Cy_Em_EEPROM_Init() */
+cy_rslt_t mtb_block_storage_nvm_create(mtb_block_storage_t* bsd);
+
+#endif /* MTB_BLOCK_STORAGE_H */
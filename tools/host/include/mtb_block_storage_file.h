@@ -0,0 +1,77 @@
+/***************************************************************************//**
+* \file mtb_block_storage_file.h
+*
+* \brief
+*  Block device backed by a memory-mapped file for the Em_EEPROM host tools.
+*  The file is mapped, not loaded, so images of any size are opened at once
+*  and the reads and writes work on the page cache. With copy-on-write,
+*  the writes change the mapping only and the file is never altered.
+*
+*  The device starts at the specified offset in the file and ends at the end
+*  of the file. Program and erase operations must be aligned to the program
+*  size from the start of the device. An erase fills zeros, the erased value
+*  of the nvm the Em_EEPROM expects.
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#if !defined(MTB_BLOCK_STORAGE_FILE_H)
+#define MTB_BLOCK_STORAGE_FILE_H
+
+#include <stddef.h>
+#include "mtb_block_storage.h"
+
+#define MTB_BLOCK_STORAGE_FILE_RSLT_ERR_OPEN    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, 0x101u, 1u))
+#define MTB_BLOCK_STORAGE_FILE_RSLT_ERR_PARAM   (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, 0x101u, 2u))
+#define MTB_BLOCK_STORAGE_FILE_RSLT_ERR_RANGE   (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, 0x101u, 3u))
+
+/** The configuration of the file block device */
+typedef struct
+{
+    const char* path;           /**< The file to map */
+    uint32_t offset;            /**< The offset of the device in the file, a multiple of
+                                 *   programSize */
+    uint32_t baseAddr;          /**< The address of the device, not zero */
+    uint32_t programSize;       /**< The program and erase size, a multiple of 4 */
+    bool copyOnWrite;           /**< The writes are not stored to the file */
+} mtb_block_storage_file_config_t;
+
+/** The file block device object, the context of the block device functions */
+typedef struct
+{
+    uint8_t* map;               /**< The mapping of the whole file */
+    size_t mapSize;             /**< The size of the mapping */
+    uint8_t* mem;               /**< The start of the device in the mapping */
+    uint32_t size;              /**< The size of the device */
+    uint32_t baseAddr;          /**< The address of the device */
+    uint32_t programSize;       /**< The program and erase size */
+    bool copyOnWrite;           /**< The writes are not stored to the file */
+} mtb_block_storage_file_t;
+
+/** Maps the file and initializes the block device over it.
+ *
+ * @param[out] bsd      The block device to initialize.
+ * @param[out] file     The file block device object, used as the block device context.
+ * @param[in]  config   The configuration of the device.
+ *
+ * @return CY_RSLT_SUCCESS or the error of the file block device.
+ */
+cy_rslt_t mtb_block_storage_file_create(mtb_block_storage_t* bsd, mtb_block_storage_file_t* file,
+                                        const mtb_block_storage_file_config_t* config);
+
+/** Unmaps the file. The writes without copy-on-write are synchronized to the file first.
+ *
+ * @param[in] file      The file block device object.
+ *
+ * @return CY_RSLT_SUCCESS or MTB_BLOCK_STORAGE_FILE_RSLT_ERR_OPEN if the synchronization
+ * failed.
+ */
+cy_rslt_t mtb_block_storage_file_free(mtb_block_storage_file_t* file);
+
+#endif /* MTB_BLOCK_STORAGE_FILE_H */
@@ -0,0 +1,180 @@
+/***************************************************************************//**
+* \file mtb_block_storage_file.c
+*
+* \brief
+*  Block device backed by a memory-mapped file for the Em_EEPROM host tools.
+*  See mtb_block_storage_file.h.
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mtb_block_storage_file.h"
+
+
+static bool IsInRange(const mtb_block_storage_file_t* file, uint32_t addr, uint32_t length)
+{
+    return ((addr >= file->baseAddr) && (length <= file->size) &&
+            ((addr - file->baseAddr) <= (file->size - length)));
+}
+
+
+static bool IsAligned(const mtb_block_storage_file_t* file, uint32_t addr, uint32_t length)
+{
+    return ((0u == ((addr - file->baseAddr) % file->programSize)) &&
+            (0u == (length % file->programSize)));
+}
+
+
+static cy_rslt_t FileRead(void* context, uint32_t addr, uint32_t length, uint8_t* buf)
+{
+    const mtb_block_storage_file_t* file = (const mtb_block_storage_file_t*)context;
+
+    if (!IsInRange(file, addr, length))
+    {
+        return MTB_BLOCK_STORAGE_FILE_RSLT_ERR_RANGE;
+    }
+    (void)memcpy(buf, &file->mem[addr - file->baseAddr], length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+static cy_rslt_t FileProgram(void* context, uint32_t addr, uint32_t length, const uint8_t* buf)
+{
+    mtb_block_storage_file_t* file = (mtb_block_storage_file_t*)context;
+
+    if (!IsInRange(file, addr, length) || !IsAligned(file, addr, length))
+    {
+        return MTB_BLOCK_STORAGE_FILE_RSLT_ERR_RANGE;
+    }
+    (void)memcpy(&file->mem[addr - file->baseAddr], buf, length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+static cy_rslt_t FileErase(void* context, uint32_t addr, uint32_t length)
+{
+    mtb_block_storage_file_t* file = (mtb_block_storage_file_t*)context;
+
+    if (!IsInRange(file, addr, length) || !IsAligned(file, addr, length))
+    {
+        return MTB_BLOCK_STORAGE_FILE_RSLT_ERR_RANGE;
+    }
+    (void)memset(&file->mem[addr - file->baseAddr], 0, length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+static uint32_t FileGetProgramSize(void* context, uint32_t addr)
+{
+    (void)addr;
+    return ((const mtb_block_storage_file_t*)context)->programSize;
+}
+
+
+static bool FileIsInRange(void* context, uint32_t addr, uint32_t length)
+{
+    return IsInRange((const mtb_block_storage_file_t*)context, addr, length);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_block_storage_file_create
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_block_storage_file_create(mtb_block_storage_t* bsd, mtb_block_storage_file_t* file,
+                                        const mtb_block_storage_file_config_t* config)
+{
+    cy_rslt_t result = MTB_BLOCK_STORAGE_FILE_RSLT_ERR_PARAM;
+    struct stat info;
+    int fd;
+
+    if ((NULL != bsd) && (NULL != file) && (NULL != config) && (0u != config->baseAddr) &&
+        (0u != config->programSize) && (0u == (config->programSize % 4u)) &&
+        (0u == (config->offset % config->programSize)))
+    {
+        (void)memset(file, 0, sizeof(*file));
+        result = MTB_BLOCK_STORAGE_FILE_RSLT_ERR_OPEN;
+        /* The copy-on-write mapping is private, so the file is opened read-only */
+        fd = open(config->path, config->copyOnWrite ? O_RDONLY : O_RDWR);
+        if ((0 <= fd) && (0 == fstat(fd, &info)))
+        {
+            result = MTB_BLOCK_STORAGE_FILE_RSLT_ERR_RANGE;
+            if ((info.st_size > (off_t)config->offset) &&
+                ((info.st_size - (off_t)config->offset) <= (off_t)UINT32_MAX) &&
+                ((uint64_t)config->baseAddr + (uint64_t)(info.st_size - config->offset) <=
+                 ((uint64_t)UINT32_MAX + 1u)))
+            {
+                file->map = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE,
+                                 config->copyOnWrite ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+                result = (MAP_FAILED != file->map) ? CY_RSLT_SUCCESS :
+                         MTB_BLOCK_STORAGE_FILE_RSLT_ERR_OPEN;
+            }
+        }
+        if (0 <= fd)
+        {
+            /* The mapping stays valid after the file is closed */
+            (void)close(fd);
+        }
+
+        if (CY_RSLT_SUCCESS == result)
+        {
+            file->mapSize = (size_t)info.st_size;
+            file->mem = &file->map[config->offset];
+            file->size = (uint32_t)(info.st_size - (off_t)config->offset);
+            file->baseAddr = config->baseAddr;
+            file->programSize = config->programSize;
+            file->copyOnWrite = config->copyOnWrite;
+
+            bsd->read = FileRead;
+            bsd->program = FileProgram;
+            bsd->erase = FileErase;
+            bsd->program_nb = FileProgram;
+            bsd->erase_nb = FileErase;
+            bsd->get_read_size = FileGetProgramSize;
+            bsd->get_program_size = FileGetProgramSize;
+            bsd->get_erase_size = FileGetProgramSize;
+            bsd->is_in_range = FileIsInRange;
+            bsd->is_erase_required = true;
+            bsd->context = file;
+        }
+        else
+        {
+            file->map = NULL;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// mtb_block_storage_file_free
+//--------------------------------------------------------------------------------------------------
+cy_rslt_t mtb_block_storage_file_free(mtb_block_storage_file_t* file)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if ((NULL != file) && (NULL != file->map))
+    {
+        if (!file->copyOnWrite && (0 != msync(file->map, file->mapSize, MS_SYNC)))
+        {
+            result = MTB_BLOCK_STORAGE_FILE_RSLT_ERR_OPEN;
+        }
+        (void)munmap(file->map, file->mapSize);
+        file->map = NULL;
+        file->mem = NULL;
+        file->size = 0u;
+    }
+
+    return result;
+}
@@ -0,0 +1,348 @@
+/***************************************************************************//**
+* \file imagebuilder.c
+*
+* \brief
+*  Host image builder for the factory provisioning of the Emulated EEPROM.
+*
+*  The builder takes the logical Em_EEPROM content from a binary file and
+*  the Em_EEPROM configuration from the command line. It writes the content
+*  with Cy_Em_EEPROM_WriteImage() to a block device in RAM and saves
+*  the resulting physical nvm image: the rows with their sequence numbers,
+*  headers, checksums and the redundant copy. Program the image at
+*  userNvmStartAddr together with the firmware. Cy_Em_EEPROM_Init_BD() with
+*  the same configuration uses it as is.
+*
+*  The image does not depend on userNvmStartAddr. It depends on the program
+*  size of the nvm. The rows not written are filled with zeros, the erased
+*  value of the nvm the Em_EEPROM expects.
+*
+*  Before saving, the builder initializes the Em_EEPROM again from the image
+*  and verifies that the whole content reads back.
+*
+*  Usage: imagebuilder [options] <input file> <output file>
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cy_em_eeprom.h"
+
+/*******************************************************************************
+* Block device in RAM
+*******************************************************************************/
+/* Any non-zero address, the image does not depend on it */
+#define IB_BASE_ADDR                    (0x10000000u)
+
+#define IB_RSLT_ERR                     (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, 0x100u, 1u))
+
+typedef struct
+{
+    uint8_t* mem;
+    uint32_t size;
+    uint32_t programSize;
+} ib_bd_t;
+
+static ib_bd_t ram;
+static mtb_block_storage_t ramBd;
+
+
+static bool IsInRange(uint32_t addr, uint32_t length)
+{
+    return ((addr >= IB_BASE_ADDR) && (length <= ram.size) &&
+            ((addr - IB_BASE_ADDR) <= (ram.size - length)));
+}
+
+
+static cy_rslt_t RamRead(void* context, uint32_t addr, uint32_t length, uint8_t* buf)
+{
+    (void)context;
+    if (!IsInRange(addr, length))
+    {
+        return IB_RSLT_ERR;
+    }
+    (void)memcpy(buf, &ram.mem[addr - IB_BASE_ADDR], length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+static cy_rslt_t RamProgram(void* context, uint32_t addr, uint32_t length, const uint8_t* buf)
+{
+    (void)context;
+    if (!IsInRange(addr, length) || (0u != (addr % ram.programSize)) ||
+        (0u != (length % ram.programSize)))
+    {
+        return IB_RSLT_ERR;
+    }
+    (void)memcpy(&ram.mem[addr - IB_BASE_ADDR], buf, length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+static cy_rslt_t RamErase(void* context, uint32_t addr, uint32_t length)
+{
+    (void)context;
+    if (!IsInRange(addr, length))
+    {
+        return IB_RSLT_ERR;
+    }
+    (void)memset(&ram.mem[addr - IB_BASE_ADDR], 0, length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+static uint32_t RamGetProgramSize(void* context, uint32_t addr)
+{
+    (void)context;
+    (void)addr;
+    return ram.programSize;
+}
+
+
+/*******************************************************************************
+* Function Name: RamIsInRange
+****************************************************************************//**
+*
+* Allocates the RAM for the nvm range checked by Cy_Em_EEPROM_Init_BD(), so
+* the image has exactly the physical size of the configuration.
+*
+*******************************************************************************/
+static bool RamIsInRange(void* context, uint32_t addr, uint32_t length)
+{
+    (void)context;
+    if ((NULL == ram.mem) && (IB_BASE_ADDR == addr) && (0u != length))
+    {
+        ram.mem = calloc(length, 1u);
+        if (NULL != ram.mem)
+        {
+            ram.size = length;
+        }
+    }
+    return IsInRange(addr, length);
+}
+
+
+/* Implemented for Cy_Em_EEPROM_Init(), which is not used by the builder */
+cy_rslt_t mtb_block_storage_nvm_create(mtb_block_storage_t* bsd)
+{
+    *bsd = ramBd;
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: Usage
+****************************************************************************//**
+*
+* Prints the command line options.
+*
+*******************************************************************************/
+static void Usage(void)
+{
+    printf("Usage: imagebuilder [options] <input file> <output file>\n"
+           "  -s <size>     Em_EEPROM size in bytes, the input file size by default\n"
+           "  -p <size>     nvm program size in bytes, 512 by default\n"
+           "  -m            Simple mode\n"
+           "  -w <factor>   wear-leveling factor, 1 by default\n"
+           "  -n <rows>     wear-leveling ring length in rows, overrides -w\n"
+           "  -r            redundant copy\n"
+           "The input file shorter than the Em_EEPROM size is padded with zeros.\n");
+}
+
+
+/*******************************************************************************
+* Function Name: ReadFile
+****************************************************************************//**
+*
+* Reads the whole file into allocated memory.
+*
+*******************************************************************************/
+static uint8_t* ReadFile(const char* name, uint32_t* size)
+{
+    uint8_t* data = NULL;
+    long length;
+    FILE* file = fopen(name, "rb");
+
+    if (NULL != file)
+    {
+        if ((0 == fseek(file, 0L, SEEK_END)) && (0L <= (length = ftell(file))) &&
+            (0 == fseek(file, 0L, SEEK_SET)))
+        {
+            /* One extra byte, so an empty file is allocated too */
+            data = calloc((size_t)length + 1u, 1u);
+            if ((NULL != data) && ((size_t)length != fread(data, 1u, (size_t)length, file)))
+            {
+                free(data);
+                data = NULL;
+            }
+            *size = (uint32_t)length;
+        }
+        (void)fclose(file);
+    }
+    return data;
+}
+
+
+int main(int argc, char** argv)
+{
+    cy_stc_eeprom_config2_t config;
+    cy_stc_eeprom_context_t context;
+    cy_en_em_eeprom_status_t status;
+    const char* inputName = NULL;
+    const char* outputName = NULL;
+    uint8_t* input;
+    uint8_t* content;
+    uint8_t* readBack;
+    uint32_t inputSize = 0u;
+    uint32_t eepromSize = 0u;
+    FILE* output;
+    int i;
+
+    (void)memset(&config, 0, sizeof(config));
+    config.wearLevelingFactor = 1u;
+    config.blockingWrite = 1u;
+    config.userNvmStartAddr = IB_BASE_ADDR;
+    ram.programSize = 512u;
+
+    for (i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        bool hasValue = ((i + 1) < argc);
+
+        if ((0 == strcmp(arg, "-s")) && hasValue)
+        {
+            eepromSize = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if ((0 == strcmp(arg, "-p")) && hasValue)
+        {
+            ram.programSize = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (0 == strcmp(arg, "-m"))
+        {
+            config.simpleMode = 1u;
+        }
+        else if ((0 == strcmp(arg, "-w")) && hasValue)
+        {
+            config.wearLevelingFactor = (uint8_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if ((0 == strcmp(arg, "-n")) && hasValue)
+        {
+            config.wearLevelingRows = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (0 == strcmp(arg, "-r"))
+        {
+            config.redundantCopy = 1u;
+        }
+        else if (('-' != arg[0]) && (NULL == inputName))
+        {
+            inputName = arg;
+        }
+        else if (('-' != arg[0]) && (NULL == outputName))
+        {
+            outputName = arg;
+        }
+        else
+        {
+            Usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (0u != config.wearLevelingRows)
+    {
+        /* The ring length in rows is used only with the factor set to zero */
+        config.wearLevelingFactor = 0u;
+    }
+    if ((NULL == outputName) || (0u == ram.programSize) ||
+        (0u != (ram.programSize % CY_EM_EEPROM_U32)))
+    {
+        Usage();
+        return EXIT_FAILURE;
+    }
+
+    input = ReadFile(inputName, &inputSize);
+    if (NULL == input)
+    {
+        printf("Cannot read %s\n", inputName);
+        return EXIT_FAILURE;
+    }
+    if (0u == eepromSize)
+    {
+        eepromSize = inputSize;
+    }
+    if ((0u == eepromSize) || (inputSize > eepromSize))
+    {
+        printf("The input file of %u bytes does not fit the Em_EEPROM size %u\n",
+               (unsigned)inputSize, (unsigned)eepromSize);
+        return EXIT_FAILURE;
+    }
+    content = calloc(eepromSize, 1u);
+    readBack = malloc(eepromSize);
+    if ((NULL == content) || (NULL == readBack))
+    {
+        printf("Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    (void)memcpy(content, input, inputSize);
+    config.eepromSize = eepromSize;
+
+    ramBd.read = RamRead;
+    ramBd.program = RamProgram;
+    ramBd.erase = RamErase;
+    ramBd.program_nb = RamProgram;
+    ramBd.erase_nb = RamErase;
+    ramBd.get_read_size = RamGetProgramSize;
+    ramBd.get_program_size = RamGetProgramSize;
+    ramBd.get_erase_size = RamGetProgramSize;
+    ramBd.is_in_range = RamIsInRange;
+    ramBd.is_erase_required = true;
+    ramBd.context = NULL;
+
+    status = Cy_Em_EEPROM_Init_BD(&config, &context, &ramBd);
+    if (CY_EM_EEPROM_SUCCESS != status)
+    {
+        printf("The configuration is not valid: 0x%08x\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+    status = Cy_Em_EEPROM_WriteImage(content, &context);
+    if (CY_EM_EEPROM_SUCCESS != status)
+    {
+        printf("The image write failed: 0x%08x\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    /* Verifies the image as the device reads it after the power up */
+    status = Cy_Em_EEPROM_Init_BD(&config, &context, &ramBd);
+    if (CY_EM_EEPROM_SUCCESS == status)
+    {
+        status = Cy_Em_EEPROM_Read(0u, readBack, eepromSize, &context);
+    }
+    if ((CY_EM_EEPROM_SUCCESS != status) || (0 != memcmp(readBack, content, eepromSize)))
+    {
+        printf("The image verification failed: 0x%08x\n", (unsigned)status);
+        return EXIT_FAILURE;
+    }
+
+    output = fopen(outputName, "wb");
+    if ((NULL == output) || (ram.size != fwrite(ram.mem, 1u, ram.size, output)) ||
+        (0 != fclose(output)))
+    {
+        printf("Cannot write %s\n", outputName);
+        return EXIT_FAILURE;
+    }
+    printf("%s: %u bytes of nvm, %u rows of %u bytes, %u bytes of Em_EEPROM data\n",
+           outputName, (unsigned)ram.size, (unsigned)(ram.size / context.rowSize),
+           (unsigned)context.rowSize, (unsigned)eepromSize);
+
+    free(input);
+    free(content);
+    free(readBack);
+    free(ram.mem);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1916 @@
+/***************************************************************************//**
+* \file powerloss.c
+*
+* \brief
+*  Power-loss fault-injection harness for the Emulated EEPROM library.
+*
+*  The Em_EEPROM runs on a simulated block device in host memory. Every
+*  Write, WriteDelta, WriteImage, Erase and ScrubStep operation is repeated
+*  with the power cut at each possible point of its block device program and
+*  erase sequence, including the middle of a program unit and the middle of
+*  an erase. Before
+*  a ScrubStep, one copy of a row is damaged in the configurations with
+*  the redundant copy, so the cuts interrupt its repair. After each cut, the
+*  Em_EEPROM is initialized again from the simulated nvm and the following
+*  invariants are checked:
+*  * Every row written with Simple mode disabled is atomic: each part of
+*    the data stored in one row reads as either the old or the new data,
+*    and the new parts are a prefix of the written data. WriteDelta changes
+*    a few bytes spread over several headers, so only the order of its
+*    changed bytes is checked. WriteImage writes the rows in the ring order,
+*    not in the order of the data, so each of its bytes must only be either
+*    old or new.
+*  * No data outside of the written range changes.
+*  * A read does not report CY_EM_EEPROM_BAD_CHECKSUM.
+*  * Cy_Em_EEPROM_ReadPtr() of random ranges and Cy_Em_EEPROM_RegionRead()
+*    of two regions that swap the halves of the Em_EEPROM return the same
+*    data as Cy_Em_EEPROM_Read().
+*  * Cy_Em_EEPROM_GetRowWear() reports for each row a number of cycles
+*    between the ones before and after the operation, and not more than
+*    the programs of the row, except after an Erase.
+*  * The Em_EEPROM keeps working after the cut: a further write, done with
+*    Cy_Em_EEPROM_Write() or Cy_Em_EEPROM_RegionWrite(), is read back.
+*
+*  Three cases are only required to recover with a write of the whole
+*  Em_EEPROM content, and are counted as recovered:
+*  * An interrupted Erase, as the rows not erased yet are still read and
+*    may expose older data.
+*  * An interrupted WriteImage, after the check of its bytes. The headers of
+*    the old rows still in the window hide some new bytes of the image rows,
+*    which appear when the old rows leave the window.
+*  * No redundant copy and a wear-leveling ring of numberOfRows rows, where
+*    the torn row holds live historic data.
+*
+*  A torn row that passes the CRC-8 check by chance is counted as an escape
+*  and is not checked further. The rate of escapes is the expected rate of
+*  undetected tears of the row format.
+*
+*  Built with CY_EM_EEPROM_KV_ENABLE defined to 1, the harness runs
+*  the configurations with Simple mode disabled once more with
+*  Cy_Em_EEPROM_KvSet() and Cy_Em_EEPROM_KvDelete() operations. After each cut,
+*  Cy_Em_EEPROM_KvInit() builds the index again, the key of the operation must
+*  have either its old or its new value, the other keys their old values, and
+*  a further Cy_Em_EEPROM_KvSet() is read back. The values fill the small
+*  stores, so the cuts interrupt the compaction too.
+*
+*  Then Cy_Em_EEPROM_Migrate() is cut at every point for pairs of old and new
+*  configurations: rings that overlap, shrink or grow, with and without
+*  the redundant copy. Each migration starts from a random position of the old
+*  ring. After each cut, every third resume is cut again at a random point,
+*  then the resumed migration must succeed with the old content, leave no rows
+*  of the old layout, and the Em_EEPROM must keep working with the new
+*  configuration.
+*
+*  Built with CY_EM_EEPROM_FIXED_GEOMETRY defined to 1, the harness runs only
+*  the configurations with the geometry of the CY_EM_EEPROM_FIXED_* macros,
+*  and fails if there is none. The migrations are not run.
+*
+*  Usage: powerloss [operations per configuration] [seed]
+*
+********************************************************************************
+* \copyright
+* (c) (2017-2021), Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation. All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include "cy_em_eeprom.h"
+
+/*******************************************************************************
+* Simulated block device
+*******************************************************************************/
+#define SIM_BASE_ADDR                   (0x10000000u)
+#define SIM_MAX_SIZE                    (64u * 1024u)
+#define SIM_RSLT_ERR                    (CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, 0x100u, 1u))
+
+/* The maximum number of failures printed in detail */
+#define PL_MAX_REPORTED_FAILURES        (10u)
+
+/* The maximum number of rows in the wear-leveling ring with Simple mode disabled */
+#define PL_MAX_RING_ROWS                (SIM_MAX_SIZE / CY_EM_EEPROM_MINIMUM_ROW_SIZE)
+
+/* The number of ranges read with Cy_Em_EEPROM_ReadPtr() after each cut */
+#define PL_NUM_READ_PTR_CHECKS          (4u)
+
+#if (CY_EM_EEPROM_KV_ENABLE == 1u)
+/* The keys of the key/value store pass. The content checked is an image of
+ * a slot per key, each holding the value size and the value.
+ */
+#define PL_KV_NUM_KEYS                  (12u)
+#define PL_KV_MAX_VALUE_SIZE            (320u)
+#define PL_KV_SLOT_SIZE                 (2u + PL_KV_MAX_VALUE_SIZE)
+#define PL_KV_INDEX_SIZE                (64u)
+#define PL_NUM_PASSES                   (2u)
+#else
+#define PL_NUM_PASSES                   (1u)
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+
+typedef struct
+{
+    uint8_t mem[SIM_MAX_SIZE];
+    uint32_t programSize;
+    /* The value of the erased bytes */
+    uint8_t erasedValue;
+    /* The row size to detect torn rows with a valid checksum, 0 in Simple mode */
+    uint32_t rowSize;
+    /* The cut point to power off at, 0 - no power cut */
+    uint32_t cutPoint;
+    /* The number of cut points passed since the device was armed */
+    uint32_t numPoints;
+    /* The row torn by the power cut passes the checksum verification */
+    bool escaped;
+    /* The number of programs of each row of the ring at the start of the nvm */
+    uint32_t rowPrograms[PL_MAX_RING_ROWS];
+} sim_bd_t;
+
+static sim_bd_t sim;
+static jmp_buf powerCut;
+static mtb_block_storage_t simBd;
+
+
+/*******************************************************************************
+* Harness configurations
+*******************************************************************************/
+typedef struct
+{
+    const char* name;
+    uint32_t programSize;
+    bool eraseRequired;
+    /* The value of the erased bytes, also of the blank nvm */
+    uint8_t erasedValue;
+    uint32_t eepromSize;
+    uint8_t simpleMode;
+    uint8_t wearLevelingFactor;
+    uint8_t redundantCopy;
+    uint32_t wearLevelingRows;
+} pl_config_t;
+
+static const pl_config_t plConfigs[] =
+{
+    /* Internal flash with a 512 bytes row */
+    { "flash512 simple",        512u, true,  0x00u, 1000u, 1u, 1u, 0u, 0u },
+    { "flash512 wl1",           512u, true,  0x00u, 600u,  0u, 1u, 0u, 0u },
+    { "flash512 wl1 red",       512u, true,  0x00u, 600u,  0u, 1u, 1u, 0u },
+    { "flash512 wl2",           512u, true,  0x00u, 600u,  0u, 2u, 0u, 0u },
+    { "flash512 wl2 red",       512u, true,  0x00u, 600u,  0u, 2u, 1u, 0u },
+    { "flash512 wlrows4 red",   512u, true,  0x00u, 600u,  0u, 0u, 1u, 4u },
+    /* External flash with a 64 bytes program unit in a 128 bytes row */
+    { "flash64 simple",         64u,  true,  0x00u, 300u,  1u, 1u, 0u, 0u },
+    { "flash64 wl1 red",        64u,  true,  0x00u, 300u,  0u, 1u, 1u, 0u },
+    { "flash64 wl3",            64u,  true,  0x00u, 300u,  0u, 3u, 0u, 0u },
+    { "flash64 wlrows7",        64u,  true,  0x00u, 300u,  0u, 0u, 0u, 7u },
+    /* Serial NOR flash that erases to ones with a 512 bytes row */
+    { "nor512 wl2",             512u, true,  0xFFu, 600u,  0u, 2u, 0u, 0u },
+    { "nor512 wl1 red",         512u, true,  0xFFu, 600u,  0u, 1u, 1u, 0u },
+    /* Storage without erase with a 16 bytes program unit in a 128 bytes row */
+    { "rram16 wl1",             16u,  false, 0x00u, 200u,  0u, 1u, 0u, 0u },
+    { "rram16 wl2 red",         16u,  false, 0x00u, 200u,  0u, 2u, 1u, 0u },
+};
+
+#if (CY_EM_EEPROM_FIXED_GEOMETRY == 0u)
+/* A configuration change checked with Cy_Em_EEPROM_Migrate() */
+typedef struct
+{
+    pl_config_t oldConfig;
+    pl_config_t newConfig;
+    /* The offset of the new layout from the old one in bytes */
+    uint32_t newOffset;
+} pl_migration_t;
+
+static const pl_migration_t plMigrations[] =
+{
+    /* The ring grows over the old one */
+    { { "flash64 wl2 red",      64u,  true,  0x00u, 300u,  0u, 2u, 1u, 0u },
+      { "flash64 wl4 red",      64u,  true,  0x00u, 400u,  0u, 4u, 1u, 0u }, 0u },
+    /* The ring shrinks within the old one and gets the redundant copy */
+    { { "flash64 wl4",          64u,  true,  0x00u, 600u,  0u, 4u, 0u, 0u },
+      { "flash64 wl1 red",      64u,  true,  0x00u, 200u,  0u, 1u, 1u, 0u }, 0u },
+    { { "flash64 wlrows16",     64u,  true,  0x00u, 250u,  0u, 0u, 0u, 16u },
+      { "flash64 wlrows5 red",  64u,  true,  0x00u, 250u,  0u, 0u, 1u, 5u }, 0u },
+    /* The redundant copy is dropped, the new ring grows over the old copy */
+    { { "flash512 wl1 red",     512u, true,  0x00u, 600u,  0u, 1u, 1u, 0u },
+      { "flash512 wl2",         512u, true,  0x00u, 1000u, 0u, 2u, 0u, 0u }, 2048u },
+    { { "rram16 wl2 red",       16u,  false, 0x00u, 200u,  0u, 2u, 1u, 0u },
+      { "rram16 wl3",           16u,  false, 0x00u, 300u,  0u, 3u, 0u, 0u }, 1024u },
+    /* The new ring cannot be placed, so the nvm must not change */
+    { { "flash64 wl1 red",      64u,  true,  0x00u, 256u,  0u, 1u, 1u, 0u },
+      { "flash64 wl1 red",      64u,  true,  0x00u, 384u,  0u, 1u, 1u, 0u }, 0u },
+};
+#endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 0u) */
+
+typedef enum
+{
+    PL_OP_WRITE,
+    PL_OP_ERASE,
+    PL_OP_KV_SET,
+    PL_OP_KV_DELETE,
+    PL_OP_MIGRATE,
+    PL_OP_SCRUB,
+    PL_OP_WRITE_DELTA,
+    PL_OP_WRITE_IMAGE
+} pl_op_type_t;
+
+static const char* const plOpNames[] =
+{
+    "write",
+    "erase",
+    "kv set",
+    "kv delete",
+    "migrate",
+    "scrub",
+    "write delta",
+    "write image"
+};
+
+typedef struct
+{
+    pl_op_type_t type;
+    /* The logical address or the key of a key/value store operation */
+    uint32_t addr;
+    uint32_t size;
+    uint8_t data[SIM_MAX_SIZE];
+} pl_op_t;
+
+typedef struct
+{
+    uint32_t operations;
+    uint32_t cuts;
+    uint32_t escapes;
+    uint32_t recovered;
+    uint32_t failures;
+} pl_result_t;
+
+static cy_stc_eeprom_config2_t eepromConfig;
+/* The configuration migrated from */
+static cy_stc_eeprom_config2_t oldEepromConfig;
+static cy_stc_eeprom_context_t eepromContext;
+static const pl_config_t* curConfig;
+static uint32_t curCut;
+static uint32_t numReportedFailures;
+static uint32_t rngState;
+/* The key/value store operations run instead of the writes */
+static bool isKvPass;
+/* The size of the checked content: eepromSize or the image of the key/value store */
+static uint32_t dataSize;
+/* The uninterrupted operation did not change the content */
+static bool isOpRejected;
+#if (CY_EM_EEPROM_KV_ENABLE == 1u)
+static cy_stc_em_eeprom_kv_entry_t kvIndex[PL_KV_INDEX_SIZE];
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+
+static uint8_t snapshotMem[SIM_MAX_SIZE];
+static uint8_t doneMem[SIM_MAX_SIZE];
+static uint8_t oldData[SIM_MAX_SIZE];
+static uint8_t newData[SIM_MAX_SIZE];
+static uint8_t readData[SIM_MAX_SIZE];
+static pl_op_t curOp;
+/* The rows of the Em_EEPROM in two regions that swap its halves */
+static cy_stc_em_eeprom_region_t plRegions[2u];
+/* The wear of the ring rows before and after the uninterrupted operation */
+static uint32_t oldWear[PL_MAX_RING_ROWS];
+static uint32_t doneWear[PL_MAX_RING_ROWS];
+static uint32_t rowWear[PL_MAX_RING_ROWS];
+/* The programs of the ring rows after the uninterrupted operation */
+static uint32_t donePrograms[PL_MAX_RING_ROWS];
+
+
+/*******************************************************************************
+* Function Name: Random
+****************************************************************************//**
+*
+* Returns the next value of the xorshift32 generator. The harness does not
+* use rand() so the scenarios are the same on all hosts.
+*
+*******************************************************************************/
+static uint32_t Random(void)
+{
+    rngState ^= rngState << 13u;
+    rngState ^= rngState >> 17u;
+    rngState ^= rngState << 5u;
+    return rngState;
+}
+
+
+/*******************************************************************************
+* Function Name: Crc8
+****************************************************************************//**
+*
+* Implements the CRC-8 of the Em_EEPROM row format.
+*
+*******************************************************************************/
+static uint8_t Crc8(const uint8_t data[], uint32_t len)
+{
+    uint8_t crc = 0xFFu;
+    uint32_t i;
+    uint32_t bit;
+
+    for (i = 0u; i < len; i++)
+    {
+        crc ^= data[i];
+        for (bit = 0u; bit < 8u; bit++)
+        {
+            crc = ((crc & 0x80u) != 0u) ? (uint8_t)((crc << 1u) ^ 0x31u) : (uint8_t)(crc << 1u);
+        }
+    }
+    return crc;
+}
+
+
+/*******************************************************************************
+* Function Name: IsRowValid
+****************************************************************************//**
+*
+* Checks if the row is written and passes the checksum verification. The upper
+* bytes of the first word are never all ones in a written row.
+*
+*******************************************************************************/
+static bool IsRowValid(const uint8_t* row)
+{
+    const uint32_t* rowWords = (const uint32_t*)row;
+    bool isBlank = ((0u == rowWords[0u]) && (0u == rowWords[1u]));
+    bool isHighOnes = (0xFFFFFF00u == (rowWords[0u] & 0xFFFFFF00u));
+
+    return (!isBlank && !isHighOnes && (row[0u] == Crc8(&row[1u], sim.rowSize - 4u)));
+}
+
+
+/*******************************************************************************
+* Function Name: PowerOff
+****************************************************************************//**
+*
+* Completes the power cut. Detects a torn row that passes the checksum
+* verification, then returns to the harness from the middle of
+* the Em_EEPROM operation.
+*
+* \param addr
+* The block device address of the interrupted operation.
+*
+* \param length
+* The length of the interrupted operation.
+*
+* \param intended
+* The content the operation was going to leave in nvm.
+*
+*******************************************************************************/
+static void PowerOff(uint32_t addr, uint32_t length, const uint8_t* intended)
+{
+    const uint8_t* row = &sim.mem[addr - SIM_BASE_ADDR];
+
+    if ((0u != sim.rowSize) && (length == sim.rowSize) && (0u != memcmp(row, intended, length)))
+    {
+        if (IsRowValid(row))
+        {
+            sim.escaped = true;
+        }
+    }
+    longjmp(powerCut, 1);
+}
+
+
+/*******************************************************************************
+* Function Name: IsCutPoint
+****************************************************************************//**
+*
+* Counts the cut point and checks if the power is cut at it.
+*
+*******************************************************************************/
+static bool IsCutPoint(void)
+{
+    sim.numPoints++;
+    return (sim.numPoints == sim.cutPoint);
+}
+
+
+static bool IsInRange(uint32_t addr, uint32_t length)
+{
+    return ((addr >= SIM_BASE_ADDR) && (length <= SIM_MAX_SIZE) &&
+            ((addr - SIM_BASE_ADDR) <= (SIM_MAX_SIZE - length)));
+}
+
+
+static cy_rslt_t SimRead(void* context, uint32_t addr, uint32_t length, uint8_t* buf)
+{
+    (void)context;
+    if (!IsInRange(addr, length))
+    {
+        return SIM_RSLT_ERR;
+    }
+    (void)memcpy(buf, &sim.mem[addr - SIM_BASE_ADDR], length);
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: SimProgram
+****************************************************************************//**
+*
+* Programs the data one program unit at a time. The power can be cut in
+* the middle of each unit, leaving the first half of it programmed, and after
+* each unit.
+*
+*******************************************************************************/
+static cy_rslt_t SimProgram(void* context, uint32_t addr, uint32_t length, const uint8_t* buf)
+{
+    uint32_t offset;
+    uint8_t* dst = &sim.mem[addr - SIM_BASE_ADDR];
+
+    (void)context;
+    if (!IsInRange(addr, length) || (0u != (addr % sim.programSize)) ||
+        (0u != (length % sim.programSize)))
+    {
+        return SIM_RSLT_ERR;
+    }
+    if ((0u != sim.rowSize) && (length == sim.rowSize) &&
+        (((addr - SIM_BASE_ADDR) / sim.rowSize) < PL_MAX_RING_ROWS))
+    {
+        sim.rowPrograms[(addr - SIM_BASE_ADDR) / sim.rowSize]++;
+    }
+    for (offset = 0u; offset < length; offset += sim.programSize)
+    {
+        if (IsCutPoint())
+        {
+            (void)memcpy(&dst[offset], &buf[offset], sim.programSize / 2u);
+            PowerOff(addr, length, buf);
+        }
+        (void)memcpy(&dst[offset], &buf[offset], sim.programSize);
+        if (IsCutPoint())
+        {
+            PowerOff(addr, length, buf);
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+
+/*******************************************************************************
+* Function Name: SimErase
+****************************************************************************//**
+*
+* Erases the nvm. The power can be cut in the middle of the erase, leaving
+* the first half of the range erased, and after the erase.
+*
+*******************************************************************************/
+static cy_rslt_t SimErase(void* context, uint32_t addr, uint32_t length)
+{
+    static uint8_t erased[SIM_MAX_SIZE];
+    uint8_t* dst = &sim.mem[addr - SIM_BASE_ADDR];
+
+    (void)context;
+    if (!IsInRange(addr, length))
+    {
+        return SIM_RSLT_ERR;
+    }
+    (void)memset(erased, sim.erasedValue, length);
+    if (IsCutPoint())
+    {
+        (void)memset(dst, sim.erasedValue, length / 2u);
+        PowerOff(addr, length, erased);
+    }
+    (void)memset(dst, sim.erasedValue, length);
+    if (IsCutPoint())
+    {
+        PowerOff(addr, length, erased);
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+
+static uint32_t SimGetProgramSize(void* context, uint32_t addr)
+{
+    (void)context;
+    (void)addr;
+    return sim.programSize;
+}
+
+
+static bool SimIsInRange(void* context, uint32_t addr, uint32_t length)
+{
+    (void)context;
+    return IsInRange(addr, length);
+}
+
+
+/* Cy_Em_EEPROM_Init() is not used by the harness */
+cy_rslt_t mtb_block_storage_nvm_create(mtb_block_storage_t* bsd)
+{
+    (void)bsd;
+    return SIM_RSLT_ERR;
+}
+
+
+/*******************************************************************************
+* Function Name: ReportFailure
+****************************************************************************//**
+*
+* Prints the failed invariant for the first PL_MAX_REPORTED_FAILURES failures.
+*
+*******************************************************************************/
+static void ReportFailure(pl_result_t* result, const char* reason, uint32_t detail)
+{
+    result->failures++;
+    if (numReportedFailures < PL_MAX_REPORTED_FAILURES)
+    {
+        numReportedFailures++;
+        printf("FAIL [%s] %s addr %u size %u cut %u: %s (%u)\n", curConfig->name,
+               plOpNames[curOp.type],
+               (unsigned)curOp.addr, (unsigned)curOp.size, (unsigned)curCut, reason,
+               (unsigned)detail);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: InitEeprom
+****************************************************************************//**
+*
+* Initializes the Em_EEPROM from the simulated nvm, and the key/value store in
+* the key/value store pass.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t InitEeprom(void)
+{
+    cy_en_em_eeprom_status_t status;
+
+    status = Cy_Em_EEPROM_Init_BD(&eepromConfig, &eepromContext, &simBd);
+    #if (CY_EM_EEPROM_KV_ENABLE == 1u)
+    if (isKvPass && (CY_EM_EEPROM_SUCCESS == status))
+    {
+        status = Cy_Em_EEPROM_KvInit(kvIndex, PL_KV_INDEX_SIZE, &eepromContext);
+    }
+    #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+    return status;
+}
+
+
+/*******************************************************************************
+* Function Name: RunOp
+****************************************************************************//**
+*
+* Runs the current operation on the Em_EEPROM.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t RunOp(void)
+{
+    cy_en_em_eeprom_status_t status;
+
+    switch (curOp.type)
+    {
+        case PL_OP_WRITE:
+            status = Cy_Em_EEPROM_Write(curOp.addr, curOp.data, curOp.size, &eepromContext);
+            break;
+        case PL_OP_WRITE_DELTA:
+            status = Cy_Em_EEPROM_WriteDelta(curOp.addr, curOp.data, curOp.size, &eepromContext);
+            break;
+        case PL_OP_WRITE_IMAGE:
+            status = Cy_Em_EEPROM_WriteImage(curOp.data, &eepromContext);
+            break;
+        case PL_OP_ERASE:
+            status = Cy_Em_EEPROM_Erase(&eepromContext);
+            break;
+        case PL_OP_MIGRATE:
+            status = Cy_Em_EEPROM_Migrate(&oldEepromConfig, &eepromConfig, &eepromContext,
+                                          &simBd);
+            break;
+        case PL_OP_SCRUB:
+            status = Cy_Em_EEPROM_ScrubStep(eepromContext.wearLevelingRows, &eepromContext);
+            break;
+        #if (CY_EM_EEPROM_KV_ENABLE == 1u)
+        case PL_OP_KV_SET:
+            status = Cy_Em_EEPROM_KvSet((uint16_t)curOp.addr, curOp.data, curOp.size,
+                                        &eepromContext);
+            break;
+        case PL_OP_KV_DELETE:
+            status = Cy_Em_EEPROM_KvDelete((uint16_t)curOp.addr, &eepromContext);
+            break;
+        #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+        default:
+            status = CY_EM_EEPROM_BAD_PARAM;
+            break;
+    }
+    return status;
+}
+
+
+/*******************************************************************************
+* Function Name: IsStatusGood
+****************************************************************************//**
+*
+* Checks the Em_EEPROM status reports valid data.
+*
+*******************************************************************************/
+static bool IsStatusGood(cy_en_em_eeprom_status_t status)
+{
+    return ((CY_EM_EEPROM_SUCCESS == status) || (CY_EM_EEPROM_REDUNDANT_COPY_USED == status));
+}
+
+
+/*******************************************************************************
+* Function Name: CheckAtomicity
+****************************************************************************//**
+*
+* Checks the data read after a cut write against the data before and after
+* the write. With Simple mode disabled, the written data is split into
+* the parts written by one row, each of them must be either old or new.
+* With Simple mode enabled, the written rows may be left in any state.
+*
+* \return
+* Returns true if the invariants hold.
+*
+*******************************************************************************/
+static bool CheckAtomicity(pl_result_t* result)
+{
+    uint32_t eepromSize = curConfig->eepromSize;
+    uint32_t i;
+    uint32_t tornStart = eepromSize;
+    uint32_t tornEnd = eepromSize;
+    bool isAtomic = (0u == curConfig->simpleMode);
+    /* The rows of an image are written in the ring order, not in the order of the data */
+    bool isOrdered = (PL_OP_WRITE_IMAGE != curOp.type);
+    bool oldSeen = false;
+    #if (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u)
+    /* A row holds a variable amount of the compressed data, so only the order is checked */
+    uint32_t partSize = 1u;
+    #else
+    uint32_t partSize = eepromContext.headerDataLength;
+    #endif /* (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u) */
+    uint32_t part;
+    uint32_t numParts;
+
+    if ((PL_OP_WRITE_DELTA == curOp.type) || (!isOrdered))
+    {
+        /* The headers start at the changed bytes and the image rows hold the historic
+         * data slots, so each byte is checked on its own.
+         */
+        partSize = 1u;
+    }
+
+    if (!isAtomic)
+    {
+        tornStart = curOp.addr - (curOp.addr % eepromContext.rowSize);
+        tornEnd = curOp.addr + curOp.size;
+        tornEnd += (eepromContext.rowSize - (tornEnd % eepromContext.rowSize)) %
+                   eepromContext.rowSize;
+    }
+
+    for (i = 0u; i < eepromSize; i++)
+    {
+        bool isInOp = (i >= curOp.addr) && (i < (curOp.addr + curOp.size));
+        bool isTorn = (i >= tornStart) && (i < tornEnd);
+
+        if (!isTorn)
+        {
+            if (isInOp)
+            {
+                if ((readData[i] != oldData[i]) && (readData[i] != newData[i]))
+                {
+                    ReportFailure(result, "byte is neither old nor new", i);
+                    return false;
+                }
+            }
+            else if (readData[i] != oldData[i])
+            {
+                ReportFailure(result, "byte outside of the operation changed", i);
+                return false;
+            }
+        }
+    }
+
+    if (isAtomic)
+    {
+        numParts = ((curOp.size - 1u) / partSize) + 1u;
+        for (part = 0u; part < numParts; part++)
+        {
+            uint32_t start = curOp.addr + (part * partSize);
+            uint32_t end = ((start + partSize) < (curOp.addr + curOp.size)) ?
+                           (start + partSize) : (curOp.addr + curOp.size);
+            bool partOld = false;
+            bool partNew = false;
+
+            for (i = start; i < end; i++)
+            {
+                if (oldData[i] != newData[i])
+                {
+                    partOld = partOld || (readData[i] == oldData[i]);
+                    partNew = partNew || (readData[i] == newData[i]);
+                }
+            }
+            if (partOld && partNew)
+            {
+                ReportFailure(result, "row data is torn", part);
+                return false;
+            }
+            if (partNew && oldSeen && isOrdered)
+            {
+                ReportFailure(result, "new row data follows old row data", part);
+                return false;
+            }
+            oldSeen = oldSeen || partOld;
+        }
+    }
+    return true;
+}
+
+
+#if (CY_EM_EEPROM_KV_ENABLE == 1u)
+/*******************************************************************************
+* Function Name: SetKvSlot
+****************************************************************************//**
+*
+* Sets the slot of a key in the image of the key/value store. A zero size
+* marks a key not present.
+*
+*******************************************************************************/
+static void SetKvSlot(uint8_t* image, uint32_t key, const uint8_t* value, uint32_t size)
+{
+    uint8_t* slot = &image[(key - 1u) * PL_KV_SLOT_SIZE];
+
+    (void)memset(slot, 0, PL_KV_SLOT_SIZE);
+    slot[0u] = (uint8_t)size;
+    slot[1u] = (uint8_t)(size >> 8u);
+    if (0u != size)
+    {
+        (void)memcpy(&slot[2u], value, size);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: ReadKvImage
+****************************************************************************//**
+*
+* Reads all keys of the key/value store into the image.
+*
+* \return
+* The status of the first failed read, or CY_EM_EEPROM_SUCCESS.
+*
+*******************************************************************************/
+static cy_en_em_eeprom_status_t ReadKvImage(uint8_t* image)
+{
+    static uint8_t value[PL_KV_MAX_VALUE_SIZE];
+    cy_en_em_eeprom_status_t status = CY_EM_EEPROM_SUCCESS;
+    cy_en_em_eeprom_status_t retGet;
+    uint32_t key;
+    uint32_t size;
+
+    for (key = 1u; key <= PL_KV_NUM_KEYS; key++)
+    {
+        size = PL_KV_MAX_VALUE_SIZE;
+        retGet = Cy_Em_EEPROM_KvGet((uint16_t)key, value, &size, &eepromContext);
+        if (CY_EM_EEPROM_KEY_NOT_FOUND == retGet)
+        {
+            size = 0u;
+        }
+        else if ((CY_EM_EEPROM_SUCCESS != retGet) && (CY_EM_EEPROM_SUCCESS == status))
+        {
+            status = retGet;
+        }
+        else
+        {
+            /* The value is read */
+        }
+        SetKvSlot(image, key, value, size);
+    }
+    return status;
+}
+
+
+/*******************************************************************************
+* Function Name: NextKvValue
+****************************************************************************//**
+*
+* Selects a key and a value: mostly small values, some values larger than
+* the header data of a row and a few large enough to fill the store. Some
+* values are the current value of the key with its first and last byte
+* changed.
+*
+* \return
+* The size of the value.
+*
+*******************************************************************************/
+static uint32_t NextKvValue(const uint8_t* image, uint32_t* key, uint8_t* value)
+{
+    const uint8_t* slot;
+    uint32_t kind = Random() % 100u;
+    uint32_t maxSize = PL_KV_MAX_VALUE_SIZE;
+    uint32_t size;
+    uint32_t i;
+
+    *key = 1u + (Random() % PL_KV_NUM_KEYS);
+    slot = &image[(*key - 1u) * PL_KV_SLOT_SIZE];
+    size = (uint32_t)slot[0u] | ((uint32_t)slot[1u] << 8u);
+    if ((0u != size) && (kind < 30u))
+    {
+        /* Changes the first and the last byte of the current value */
+        (void)memcpy(value, &slot[2u], size);
+        value[0u] = (uint8_t)(value[0u] + 1u);
+        value[size - 1u] = (uint8_t)(value[size - 1u] + 1u);
+    }
+    else
+    {
+        if (kind < 70u)
+        {
+            maxSize = 8u;
+        }
+        else if (kind < 95u)
+        {
+            maxSize = 64u;
+        }
+        else
+        {
+            /* The largest values fill the store */
+        }
+        size = 1u + (Random() % maxSize);
+        for (i = 0u; i < size; i++)
+        {
+            value[i] = (uint8_t)Random();
+        }
+    }
+    return size;
+}
+
+
+/*******************************************************************************
+* Function Name: CheckKvAfterCut
+****************************************************************************//**
+*
+* Powers the Em_EEPROM and the key/value store up again after the cut, checks
+* that each key has its old value, or its new value for the key of
+* the operation, and continues with a change of a value.
+*
+*******************************************************************************/
+static void CheckKvAfterCut(pl_result_t* result)
+{
+    static uint8_t value[PL_KV_MAX_VALUE_SIZE];
+    cy_en_em_eeprom_status_t status;
+    uint32_t key;
+    uint32_t size;
+    uint32_t offset;
+    bool isRingOverlap = (0u == curConfig->redundantCopy) &&
+                         (eepromContext.wearLevelingRows == eepromContext.numberOfRows);
+
+    status = InitEeprom();
+    if (isRingOverlap)
+    {
+        /* Any data of the overwritten row may be lost */
+        result->recovered++;
+        return;
+    }
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "key/value store init failed", status);
+        return;
+    }
+    status = ReadKvImage(readData);
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "read failed", status);
+        return;
+    }
+    for (key = 1u; key <= PL_KV_NUM_KEYS; key++)
+    {
+        offset = (key - 1u) * PL_KV_SLOT_SIZE;
+        if ((0 != memcmp(&readData[offset], &oldData[offset], PL_KV_SLOT_SIZE)) &&
+            ((key != curOp.addr) ||
+             (0 != memcmp(&readData[offset], &newData[offset], PL_KV_SLOT_SIZE))))
+        {
+            ReportFailure(result, (key == curOp.addr) ? "value is neither old nor new" :
+                          "value of another key changed", key);
+            return;
+        }
+    }
+
+    /* Continues with a change of a value */
+    size = NextKvValue(readData, &key, value);
+    status = Cy_Em_EEPROM_KvSet((uint16_t)key, value, size, &eepromContext);
+    if (CY_EM_EEPROM_SUCCESS == status)
+    {
+        SetKvSlot(readData, key, value, size);
+    }
+    else if (CY_EM_EEPROM_NO_SPACE != status)
+    {
+        ReportFailure(result, "write after the cut failed", status);
+        return;
+    }
+    else
+    {
+        /* The store is full */
+    }
+    status = ReadKvImage(newData);
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "read after the write failed", status);
+        return;
+    }
+    if (0u != memcmp(newData, readData, dataSize))
+    {
+        ReportFailure(result, "data mismatch after the write", key);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: NextKvOp
+****************************************************************************//**
+*
+* Selects the next key/value store operation: mostly value changes and some
+* deletions.
+*
+*******************************************************************************/
+static void NextKvOp(void)
+{
+    uint32_t key;
+
+    curOp.type = PL_OP_KV_SET;
+    curOp.size = NextKvValue(oldData, &key, curOp.data);
+    curOp.addr = key;
+    if ((Random() % 100u) < 15u)
+    {
+        curOp.type = PL_OP_KV_DELETE;
+        curOp.size = 0u;
+    }
+}
+
+
+#endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+
+
+/*******************************************************************************
+* Function Name: SetNewData
+****************************************************************************//**
+*
+* Sets the content expected after the current operation.
+*
+*******************************************************************************/
+static void SetNewData(void)
+{
+    (void)memcpy(newData, oldData, dataSize);
+    if (!isOpRejected)
+    {
+        switch (curOp.type)
+        {
+            case PL_OP_WRITE:
+            case PL_OP_WRITE_DELTA:
+            case PL_OP_WRITE_IMAGE:
+                (void)memcpy(&newData[curOp.addr], curOp.data, curOp.size);
+                break;
+            case PL_OP_ERASE:
+                (void)memset(newData, 0, dataSize);
+                break;
+            case PL_OP_MIGRATE:
+                /* The content moves unchanged, oldData is zero beyond the old eepromSize */
+                break;
+            case PL_OP_SCRUB:
+                /* The repair does not change the content */
+                break;
+            #if (CY_EM_EEPROM_KV_ENABLE == 1u)
+            case PL_OP_KV_SET:
+            case PL_OP_KV_DELETE:
+                SetKvSlot(newData, curOp.addr, curOp.data, curOp.size);
+                break;
+            #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+            default:
+                /* The operation does not change the content */
+                break;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: CheckReadPaths
+****************************************************************************//**
+*
+* Checks that Cy_Em_EEPROM_ReadPtr() of random ranges and
+* Cy_Em_EEPROM_RegionRead() of the swapped halves return the content read by
+* Cy_Em_EEPROM_Read() into readData. Uses newData as a scratch buffer.
+*
+* \return
+* True if the content matches.
+*
+*******************************************************************************/
+static bool CheckReadPaths(pl_result_t* result)
+{
+    cy_en_em_eeprom_status_t status;
+    uint32_t eepromSize = curConfig->eepromSize;
+    uint32_t lowSize = plRegions[1u].size;
+    const void* ptr;
+    uint32_t addr;
+    uint32_t size;
+    uint32_t i;
+
+    for (i = 0u; i < PL_NUM_READ_PTR_CHECKS; i++)
+    {
+        addr = Random() % eepromSize;
+        size = 1u + (Random() % (eepromSize - addr));
+        status = Cy_Em_EEPROM_ReadPtr(addr, size, newData, &ptr, &eepromContext);
+        if (!IsStatusGood(status))
+        {
+            ReportFailure(result, "read of the pointer failed", status);
+            return false;
+        }
+        if (0u != memcmp(ptr, &readData[addr], size))
+        {
+            ReportFailure(result, "pointer data mismatch", addr);
+            return false;
+        }
+    }
+
+    status = Cy_Em_EEPROM_RegionRead(0u, newData, eepromSize, plRegions, 2u);
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "region read failed", status);
+        return false;
+    }
+    if ((0u != memcmp(newData, &readData[lowSize], eepromSize - lowSize)) ||
+        (0u != memcmp(&newData[eepromSize - lowSize], readData, lowSize)))
+    {
+        ReportFailure(result, "region data mismatch", lowSize);
+        return false;
+    }
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: HasErasedRows
+****************************************************************************//**
+*
+* Checks if neighbor rows of the ring have the same sequence number, as
+* the rows cleared by Cy_Em_EEPROM_Erase() do.
+*
+*******************************************************************************/
+static bool HasErasedRows(void)
+{
+    const uint8_t* row = &sim.mem[eepromContext.userNvmStartAddr - SIM_BASE_ADDR];
+    bool isShared = false;
+    uint32_t i;
+
+    for (i = 1u; (i < eepromContext.wearLevelingRows) && !isShared; i++)
+    {
+        /* The first two words hold the checksum and the sequence number */
+        isShared = (0u == memcmp(row, &row[eepromContext.rowSize], 2u * CY_EM_EEPROM_U32)) &&
+                   IsRowValid(row);
+        row = &row[eepromContext.rowSize];
+    }
+    return isShared;
+}
+
+
+/*******************************************************************************
+* Function Name: CheckRowWear
+****************************************************************************//**
+*
+* Checks that Cy_Em_EEPROM_GetRowWear() reports for each row of the ring
+* a number of cycles between the ones before and after the uninterrupted
+* operation. The rows written by the cut operation are counted or not, but
+* no row loses or gains other cycles. No row has more cycles than the row
+* programs done by the uninterrupted operations.
+*
+* \return
+* True if the wear is in range.
+*
+*******************************************************************************/
+static bool CheckRowWear(pl_result_t* result)
+{
+    cy_en_em_eeprom_status_t status;
+    uint32_t minWear;
+    uint32_t maxWear;
+    uint32_t i;
+
+    /* The number of writes is not stored in Simple mode */
+    status = Cy_Em_EEPROM_GetRowWear(rowWear, PL_MAX_RING_ROWS, &eepromContext);
+    if (status != ((0u != curConfig->simpleMode) ? CY_EM_EEPROM_BAD_PARAM : CY_EM_EEPROM_SUCCESS))
+    {
+        ReportFailure(result, "row wear failed", status);
+        return false;
+    }
+    if ((0u != curConfig->simpleMode) || (PL_OP_ERASE == curOp.type) || HasErasedRows())
+    {
+        /* An Erase leaves the rows with one sequence number, so the last written row
+         * and the wear of the rows are not defined.
+         */
+        return true;
+    }
+    for (i = 0u; i < eepromContext.wearLevelingRows; i++)
+    {
+        minWear = (oldWear[i] < doneWear[i]) ? oldWear[i] : doneWear[i];
+        maxWear = (oldWear[i] < doneWear[i]) ? doneWear[i] : oldWear[i];
+        if ((rowWear[i] < minWear) || (rowWear[i] > maxWear) || (rowWear[i] > donePrograms[i]))
+        {
+            ReportFailure(result, "row wear out of range", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*******************************************************************************
+* Function Name: CheckAfterCut
+****************************************************************************//**
+*
+* Powers the Em_EEPROM up again after the cut, checks the invariants and
+* continues writing.
+*
+*******************************************************************************/
+static void CheckAfterCut(pl_result_t* result)
+{
+    cy_en_em_eeprom_status_t status;
+    uint32_t eepromSize = curConfig->eepromSize;
+    uint32_t addr = 0u;
+    uint32_t size = eepromSize;
+    uint32_t i;
+
+    /* The new row overwrites the oldest row of the ring. Without the redundant copy,
+     * it holds live historic data if the ring has only numberOfRows rows.
+     */
+    bool isRingOverlap = (0u == curConfig->simpleMode) && (0u == curConfig->redundantCopy) &&
+                         (eepromContext.wearLevelingRows == eepromContext.numberOfRows);
+
+    #if (CY_EM_EEPROM_KV_ENABLE == 1u)
+    if (isKvPass)
+    {
+        CheckKvAfterCut(result);
+        return;
+    }
+    #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+
+    status = Cy_Em_EEPROM_Init_BD(&eepromConfig, &eepromContext, &simBd);
+    if (CY_EM_EEPROM_SUCCESS != status)
+    {
+        ReportFailure(result, "init failed", status);
+        return;
+    }
+
+    status = Cy_Em_EEPROM_Read(0u, readData, eepromSize, &eepromContext);
+    if (isRingOverlap || (curOp.type == PL_OP_ERASE))
+    {
+        /* Any data of the overwritten row may be lost. The rows not erased yet are
+         * not consistent with the erased rows.
+         */
+        result->recovered++;
+    }
+    else if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "read failed", status);
+        return;
+    }
+    else if (!CheckAtomicity(result))
+    {
+        return;
+    }
+    else if (PL_OP_WRITE_IMAGE == curOp.type)
+    {
+        /* The headers of the old rows in the window hide the new bytes of the image rows
+         * until the old rows leave the window, so the content is written again.
+         */
+        result->recovered++;
+    }
+    else
+    {
+        /* Continues with a random write */
+        addr = Random() % eepromSize;
+        size = 1u + (Random() % (eepromSize - addr));
+    }
+
+    if (IsStatusGood(status) && (!CheckReadPaths(result) || !CheckRowWear(result)))
+    {
+        return;
+    }
+
+    for (i = 0u; i < size; i++)
+    {
+        newData[i] = (uint8_t)Random();
+    }
+    if (0u != (Random() & 1u))
+    {
+        /* Writes the range at the same logical address of the swapped halves */
+        for (i = 0u; i < size; i++)
+        {
+            readData[(addr + i + plRegions[1u].size) % eepromSize] = newData[i];
+        }
+        status = Cy_Em_EEPROM_RegionWrite(addr, newData, size, plRegions, 2u);
+    }
+    else
+    {
+        (void)memcpy(&readData[addr], newData, size);
+        status = Cy_Em_EEPROM_Write(addr, newData, size, &eepromContext);
+    }
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "write after the cut failed", status);
+        return;
+    }
+    status = Cy_Em_EEPROM_Read(0u, newData, eepromSize, &eepromContext);
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "read after the write failed", status);
+        return;
+    }
+    if (0u != memcmp(newData, readData, eepromSize))
+    {
+        ReportFailure(result, "data mismatch after the write", addr);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: NextScrubOp
+****************************************************************************//**
+*
+* Selects a ScrubStep of the whole ring. With the redundant copy, one copy of
+* a random row written in both copies is damaged first.
+*
+*******************************************************************************/
+static void NextScrubOp(void)
+{
+    uint32_t offset;
+    uint8_t* row;
+    uint8_t* rowCopy;
+    uint8_t* damaged;
+
+    curOp.type = PL_OP_SCRUB;
+    curOp.addr = 0u;
+    curOp.size = curConfig->eepromSize;
+    if (0u != curConfig->redundantCopy)
+    {
+        offset = (eepromContext.userNvmStartAddr - SIM_BASE_ADDR) +
+                 ((Random() % eepromContext.wearLevelingRows) * eepromContext.rowSize);
+        row = &sim.mem[offset];
+        rowCopy = &sim.mem[offset + eepromContext.redundantOffset];
+        if (IsRowValid(row) && IsRowValid(rowCopy))
+        {
+            /* Damages the historic data. The checksum does not cover the last three bytes. */
+            damaged = (0u == (Random() % 2u)) ? row : rowCopy;
+            damaged[eepromContext.byteInRow + (Random() % (eepromContext.byteInRow - 3u))] ^= 0x5Au;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: NextDeltaOp
+****************************************************************************//**
+*
+* Selects a WriteDelta of the current content with up to four bytes changed,
+* so the changes mostly take separate headers.
+*
+*******************************************************************************/
+static void NextDeltaOp(void)
+{
+    uint32_t eepromSize = curConfig->eepromSize;
+    uint32_t numChanges = 1u + (Random() % 4u);
+    uint32_t i;
+
+    curOp.type = PL_OP_WRITE_DELTA;
+    curOp.addr = Random() % eepromSize;
+    curOp.size = 1u + (Random() % (eepromSize - curOp.addr));
+    (void)memcpy(curOp.data, &oldData[curOp.addr], curOp.size);
+    for (i = 0u; i < numChanges; i++)
+    {
+        curOp.data[Random() % curOp.size] ^= (uint8_t)(1u + (Random() % 255u));
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: NextImageOp
+****************************************************************************//**
+*
+* Selects a WriteImage of the current content with a random range changed.
+*
+*******************************************************************************/
+static void NextImageOp(void)
+{
+    uint32_t eepromSize = curConfig->eepromSize;
+    uint32_t addr = Random() % eepromSize;
+    uint32_t size = 1u + (Random() % (eepromSize - addr));
+    uint32_t i;
+
+    curOp.type = PL_OP_WRITE_IMAGE;
+    curOp.addr = 0u;
+    curOp.size = eepromSize;
+    (void)memcpy(curOp.data, oldData, eepromSize);
+    for (i = addr; i < (addr + size); i++)
+    {
+        curOp.data[i] = (uint8_t)Random();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: NextOp
+****************************************************************************//**
+*
+* Selects the next operation: mostly short writes, some long writes over
+* multiple rows, delta writes, a few erases and image writes and, with Simple
+* mode disabled, scrubs.
+*
+*******************************************************************************/
+static void NextOp(void)
+{
+    uint32_t eepromSize = curConfig->eepromSize;
+    uint32_t kind = Random() % 100u;
+    uint32_t i;
+
+    #if (CY_EM_EEPROM_KV_ENABLE == 1u)
+    if (isKvPass)
+    {
+        NextKvOp();
+        return;
+    }
+    #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+
+    curOp.type = PL_OP_WRITE;
+    if (kind < 5u)
+    {
+        curOp.type = PL_OP_ERASE;
+        curOp.addr = 0u;
+        curOp.size = eepromSize;
+    }
+    else if ((kind < 10u) && (0u == curConfig->simpleMode))
+    {
+        NextScrubOp();
+        return;
+    }
+    else if (kind < 20u)
+    {
+        NextDeltaOp();
+        return;
+    }
+    else if (kind < 23u)
+    {
+        NextImageOp();
+        return;
+    }
+    else if (kind < 35u)
+    {
+        curOp.addr = Random() % eepromSize;
+        curOp.size = 1u + (Random() % (eepromSize - curOp.addr));
+    }
+    else
+    {
+        curOp.addr = Random() % eepromSize;
+        curOp.size = 1u + (Random() % (((eepromSize - curOp.addr) < 16u) ?
+                                       (eepromSize - curOp.addr) : 16u));
+    }
+    for (i = 0u; i < curOp.size; i++)
+    {
+        curOp.data[i] = (uint8_t)Random();
+        #if (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u)
+        /* Repeated bytes make the written data compressible */
+        if ((0u != i) && (0u != (Random() % 8u)))
+        {
+            curOp.data[i] = curOp.data[i - 1u];
+        }
+        #endif /* (CY_EM_EEPROM_COMPRESSION_ENABLE == 1u) */
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: FillEepromConfig
+****************************************************************************//**
+*
+* Fills the Em_EEPROM configuration of a harness configuration placed at
+* the specified offset of the simulated nvm.
+*
+*******************************************************************************/
+static void FillEepromConfig(
+    cy_stc_eeprom_config2_t* config2,
+    const pl_config_t* config,
+    uint32_t offset)
+{
+    (void)memset(config2, 0, sizeof(*config2));
+    config2->eepromSize = config->eepromSize;
+    config2->simpleMode = config->simpleMode;
+    config2->wearLevelingFactor = config->wearLevelingFactor;
+    config2->redundantCopy = config->redundantCopy;
+    config2->wearLevelingRows = config->wearLevelingRows;
+    config2->blockingWrite = 1u;
+    config2->userNvmStartAddr = SIM_BASE_ADDR + offset;
+}
+
+
+#if (CY_EM_EEPROM_FIXED_GEOMETRY == 1u)
+/*******************************************************************************
+* Function Name: IsFixedGeometry
+****************************************************************************//**
+*
+* Checks that a harness configuration has the geometry fixed by
+* the CY_EM_EEPROM_FIXED_* macros of the build.
+*
+*******************************************************************************/
+static bool IsFixedGeometry(const pl_config_t* config)
+{
+    uint32_t rowSize = config->programSize;
+    uint32_t numberOfRows;
+
+    if (rowSize < CY_EM_EEPROM_MINIMUM_ROW_SIZE)
+    {
+        rowSize = (((CY_EM_EEPROM_MINIMUM_ROW_SIZE - 1u) / rowSize) + 1u) * rowSize;
+    }
+    numberOfRows = ((config->eepromSize - 1u) / (rowSize / 2u)) + 1u;
+
+    return ((0u == config->simpleMode) &&
+            (CY_EM_EEPROM_FIXED_ROW_SIZE == rowSize) &&
+            (CY_EM_EEPROM_FIXED_EEPROM_SIZE == config->eepromSize) &&
+            (CY_EM_EEPROM_FIXED_WEAR_LEVELING_ROWS ==
+             ((0u == config->wearLevelingFactor) ? config->wearLevelingRows :
+              (numberOfRows * config->wearLevelingFactor))));
+}
+#endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 1u) */
+
+
+#if (CY_EM_EEPROM_FIXED_GEOMETRY == 0u)
+/*******************************************************************************
+* Function Name: CountOtherLayoutRows
+****************************************************************************//**
+*
+* Counts the valid rows in the simulated nvm with a layout id other than
+* the one of the Em_EEPROM context.
+*
+*******************************************************************************/
+static uint32_t CountOtherLayoutRows(void)
+{
+    uint32_t numRows = 0u;
+    uint32_t offset;
+    uint32_t layoutId;
+    const uint32_t* rowWords;
+
+    for (offset = 0u; offset < SIM_MAX_SIZE; offset += sim.rowSize)
+    {
+        rowWords = (const uint32_t*)&sim.mem[offset];
+        /* The header word holds bits 32..55 of the sequence number above the checksum */
+        layoutId = (rowWords[0u] >> (CY_EM_EEPROM_HEADER_SEQ_NUM_HIGH_POS +
+                                     (CY_EM_EEPROM_SEQ_NUM_LAYOUT_POS - 32u))) &
+                   CY_EM_EEPROM_LAYOUT_ID_MASK;
+        if (IsRowValid(&sim.mem[offset]) && (layoutId != eepromContext.layoutId))
+        {
+            numRows++;
+        }
+    }
+    return numRows;
+}
+
+
+/*******************************************************************************
+* Function Name: CheckMigrationAfterCut
+****************************************************************************//**
+*
+* Powers up after the cut and resumes the migration, every third time with
+* one more cut at a random point. Checks that the migration completes with
+* the old content and no rows of the old layout, then continues with a write
+* and a restart with Cy_Em_EEPROM_Init_BD().
+*
+*******************************************************************************/
+static void CheckMigrationAfterCut(pl_result_t* result, uint32_t numCuts)
+{
+    cy_en_em_eeprom_status_t status;
+    uint32_t eepromSize = eepromConfig.eepromSize;
+    uint32_t addr;
+    uint32_t size;
+    uint32_t i;
+
+    if ((0u != curCut) && (0u == (curCut % 3u)))
+    {
+        sim.numPoints = 0u;
+        sim.cutPoint = 1u + (Random() % numCuts);
+        if (0 == setjmp(powerCut))
+        {
+            (void)RunOp();
+        }
+        sim.cutPoint = 0u;
+        if (sim.escaped)
+        {
+            result->escapes++;
+            return;
+        }
+    }
+
+    status = RunOp();
+    if (CY_EM_EEPROM_SUCCESS != status)
+    {
+        ReportFailure(result, "resumed migration failed", status);
+        return;
+    }
+    if (0u != CountOtherLayoutRows())
+    {
+        ReportFailure(result, "rows of other layouts left", CountOtherLayoutRows());
+        return;
+    }
+    status = Cy_Em_EEPROM_Read(0u, readData, eepromSize, &eepromContext);
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "read failed", status);
+        return;
+    }
+    for (i = 0u; i < eepromSize; i++)
+    {
+        if (readData[i] != newData[i])
+        {
+            ReportFailure(result, "migrated byte changed", i);
+            return;
+        }
+    }
+
+    /* Continues with a random write and a restart with the new configuration */
+    addr = Random() % eepromSize;
+    size = 1u + (Random() % (eepromSize - addr));
+    for (i = 0u; i < size; i++)
+    {
+        readData[addr + i] = (uint8_t)Random();
+    }
+    status = Cy_Em_EEPROM_Write(addr, &readData[addr], size, &eepromContext);
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "write after the cut failed", status);
+        return;
+    }
+    status = Cy_Em_EEPROM_Init_BD(&eepromConfig, &eepromContext, &simBd);
+    if (CY_EM_EEPROM_SUCCESS == status)
+    {
+        status = Cy_Em_EEPROM_Read(0u, newData, eepromSize, &eepromContext);
+    }
+    if (!IsStatusGood(status))
+    {
+        ReportFailure(result, "read after the restart failed", status);
+        return;
+    }
+    if (0u != memcmp(newData, readData, eepromSize))
+    {
+        ReportFailure(result, "data mismatch after the restart", addr);
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: CutMigration
+****************************************************************************//**
+*
+* Runs the migration from the snapshot with the power cut at the current cut
+* point, or uninterrupted for the cut point 0, and checks the resume.
+*
+*******************************************************************************/
+static void CutMigration(pl_result_t* result, uint32_t numCuts)
+{
+    (void)memcpy(sim.mem, snapshotMem, SIM_MAX_SIZE);
+    sim.numPoints = 0u;
+    sim.cutPoint = curCut;
+    sim.escaped = false;
+    if (0 == setjmp(powerCut))
+    {
+        (void)RunOp();
+        sim.cutPoint = 0u;
+        if (0u != curCut)
+        {
+            ReportFailure(result, "operation finished before the cut", numCuts);
+            return;
+        }
+    }
+    else
+    {
+        sim.cutPoint = 0u;
+        result->cuts++;
+    }
+    if (sim.escaped)
+    {
+        result->escapes++;
+    }
+    else
+    {
+        CheckMigrationAfterCut(result, numCuts);
+        /* CheckMigrationAfterCut() uses newData as a scratch buffer */
+        SetNewData();
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: RunMigration
+****************************************************************************//**
+*
+* Writes the old configuration from a blank nvm up to a random position of
+* its ring, then migrates it to the new configuration and cuts the power at
+* every point of the migration. Repeated for the specified number of rounds.
+*
+*******************************************************************************/
+static void RunMigration(const pl_migration_t* migration, uint32_t numRounds,
+                         pl_result_t* result)
+{
+    cy_en_em_eeprom_status_t status;
+    uint32_t round;
+    uint32_t numWrites;
+    uint32_t numCuts;
+    uint32_t i;
+
+    (void)memset(&sim, 0, sizeof(sim));
+    sim.programSize = migration->oldConfig.programSize;
+    sim.erasedValue = migration->oldConfig.erasedValue;
+    simBd.is_erase_required = migration->oldConfig.eraseRequired;
+    FillEepromConfig(&oldEepromConfig, &migration->oldConfig, 0u);
+    FillEepromConfig(&eepromConfig, &migration->newConfig, migration->newOffset);
+    isKvPass = false;
+    isOpRejected = false;
+    dataSize = eepromConfig.eepromSize;
+
+    for (round = 0u; round < numRounds; round++)
+    {
+        curConfig = &migration->oldConfig;
+        (void)memset(sim.mem, sim.erasedValue, SIM_MAX_SIZE);
+        status = Cy_Em_EEPROM_Init_BD(&oldEepromConfig, &eepromContext, &simBd);
+        if (CY_EM_EEPROM_SUCCESS != status)
+        {
+            ReportFailure(result, "configuration is not valid", status);
+            return;
+        }
+        sim.rowSize = eepromContext.rowSize;
+        numWrites = 1u + (Random() % (3u * eepromContext.wearLevelingRows));
+        for (i = 0u; (i < numWrites) && IsStatusGood(status); i++)
+        {
+            NextOp();
+            status = RunOp();
+        }
+        (void)memset(oldData, 0, SIM_MAX_SIZE);
+        if (IsStatusGood(status))
+        {
+            status = Cy_Em_EEPROM_Read(0u, oldData, oldEepromConfig.eepromSize, &eepromContext);
+        }
+        if (!IsStatusGood(status))
+        {
+            ReportFailure(result, "write of the old configuration failed", status);
+            return;
+        }
+
+        /* The uninterrupted run defines the number of cut points */
+        curConfig = &migration->newConfig;
+        curOp.type = PL_OP_MIGRATE;
+        curOp.addr = 0u;
+        curOp.size = dataSize;
+        SetNewData();
+        (void)memcpy(snapshotMem, sim.mem, SIM_MAX_SIZE);
+        sim.cutPoint = 0u;
+        sim.numPoints = 0u;
+        status = RunOp();
+        numCuts = sim.numPoints;
+        result->operations++;
+        if (CY_EM_EEPROM_NO_SPACE == status)
+        {
+            if (0 != memcmp(snapshotMem, sim.mem, SIM_MAX_SIZE))
+            {
+                ReportFailure(result, "nvm changed without the space", status);
+            }
+            continue;
+        }
+        if (CY_EM_EEPROM_SUCCESS != status)
+        {
+            ReportFailure(result, "uninterrupted operation failed", status);
+            continue;
+        }
+
+        /* The cut 0 checks the uninterrupted migration */
+        for (curCut = 0u; curCut <= numCuts; curCut++)
+        {
+            CutMigration(result, numCuts);
+        }
+    }
+}
+#endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 0u) */
+
+
+/*******************************************************************************
+* Function Name: FillRegions
+****************************************************************************//**
+*
+* Maps the Em_EEPROM to two regions of the logical address space in swapped
+* order: the upper part first, then the lower half.
+*
+*******************************************************************************/
+static void FillRegions(uint32_t eepromSize)
+{
+    uint32_t lowSize = eepromSize / 2u;
+
+    plRegions[0u].addr = 0u;
+    plRegions[0u].size = eepromSize - lowSize;
+    plRegions[0u].instanceAddr = lowSize;
+    plRegions[0u].context = &eepromContext;
+    plRegions[1u].addr = eepromSize - lowSize;
+    plRegions[1u].size = lowSize;
+    plRegions[1u].instanceAddr = 0u;
+    plRegions[1u].context = &eepromContext;
+}
+
+
+/*******************************************************************************
+* Function Name: RunConfig
+****************************************************************************//**
+*
+* Runs the operations of one configuration and cuts the power at every point
+* of each of them.
+*
+*******************************************************************************/
+static void RunConfig(const pl_config_t* config, uint32_t numOps, pl_result_t* result)
+{
+    cy_en_em_eeprom_status_t status;
+    uint32_t op;
+    uint32_t numCuts;
+    uint32_t eepromSize = config->eepromSize;
+
+    curConfig = config;
+    (void)memset(&sim, 0, sizeof(sim));
+    sim.programSize = config->programSize;
+    sim.erasedValue = config->erasedValue;
+    (void)memset(sim.mem, sim.erasedValue, SIM_MAX_SIZE);
+    simBd.is_erase_required = config->eraseRequired;
+    FillEepromConfig(&eepromConfig, config, 0u);
+
+    status = Cy_Em_EEPROM_Init_BD(&eepromConfig, &eepromContext, &simBd);
+    if (CY_EM_EEPROM_SUCCESS != status)
+    {
+        ReportFailure(result, "configuration is not valid", status);
+        return;
+    }
+    sim.rowSize = (0u == config->simpleMode) ? eepromContext.rowSize : 0u;
+    dataSize = eepromSize;
+    FillRegions(eepromSize);
+    #if (CY_EM_EEPROM_KV_ENABLE == 1u)
+    if (isKvPass)
+    {
+        dataSize = PL_KV_NUM_KEYS * PL_KV_SLOT_SIZE;
+        status = InitEeprom();
+    }
+    #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+    (void)memset(oldData, 0, dataSize);
+
+    for (op = 0u; op < numOps; op++)
+    {
+        NextOp();
+
+        /* The uninterrupted run defines the new data and the number of cut points */
+        (void)memcpy(snapshotMem, sim.mem, SIM_MAX_SIZE);
+        (void)Cy_Em_EEPROM_GetRowWear(oldWear, PL_MAX_RING_ROWS, &eepromContext);
+        sim.cutPoint = 0u;
+        sim.numPoints = 0u;
+        status = RunOp();
+        numCuts = sim.numPoints;
+        (void)Cy_Em_EEPROM_GetRowWear(doneWear, PL_MAX_RING_ROWS, &eepromContext);
+        (void)memcpy(donePrograms, sim.rowPrograms, sizeof(donePrograms));
+        (void)memcpy(doneMem, sim.mem, SIM_MAX_SIZE);
+        result->operations++;
+
+        /* A full key/value store or a deletion of a key not present changes nothing */
+        isOpRejected = (CY_EM_EEPROM_NO_SPACE == status) ||
+                       (CY_EM_EEPROM_KEY_NOT_FOUND == status);
+        SetNewData();
+
+        for (curCut = 1u; curCut <= numCuts; curCut++)
+        {
+            (void)memcpy(sim.mem, snapshotMem, SIM_MAX_SIZE);
+            (void)InitEeprom();
+            sim.numPoints = 0u;
+            sim.cutPoint = curCut;
+            sim.escaped = false;
+            if (0 == setjmp(powerCut))
+            {
+                (void)RunOp();
+                sim.cutPoint = 0u;
+                ReportFailure(result, "operation finished before the cut", numCuts);
+                continue;
+            }
+            sim.cutPoint = 0u;
+            result->cuts++;
+            if (sim.escaped)
+            {
+                result->escapes++;
+            }
+            else
+            {
+                CheckAfterCut(result);
+                /* CheckAfterCut() uses newData as a scratch buffer */
+                SetNewData();
+            }
+        }
+
+        /* Continues from the state after the uninterrupted operation */
+        (void)memcpy(sim.mem, doneMem, SIM_MAX_SIZE);
+        (void)memcpy(sim.rowPrograms, donePrograms, sizeof(donePrograms));
+        (void)InitEeprom();
+        if (IsStatusGood(status) || isOpRejected)
+        {
+            (void)memcpy(oldData, newData, dataSize);
+        }
+        else
+        {
+            ReportFailure(result, "uninterrupted operation failed", status);
+            #if (CY_EM_EEPROM_KV_ENABLE == 1u)
+            if (isKvPass)
+            {
+                (void)ReadKvImage(oldData);
+            }
+            else
+            #endif /* (CY_EM_EEPROM_KV_ENABLE == 1u) */
+            {
+                (void)Cy_Em_EEPROM_Read(0u, oldData, eepromSize, &eepromContext);
+            }
+        }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    uint32_t numOps = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 200u;
+    uint32_t pass;
+    uint32_t i;
+    pl_result_t total;
+    pl_result_t result;
+    clock_t start = clock();
+    double seconds;
+    uint32_t numRuns = 0u;
+
+    rngState = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1u;
+    if (0u == rngState)
+    {
+        rngState = 1u;
+    }
+
+    simBd.read = SimRead;
+    simBd.program = SimProgram;
+    simBd.erase = SimErase;
+    simBd.program_nb = SimProgram;
+    simBd.erase_nb = SimErase;
+    simBd.get_read_size = SimGetProgramSize;
+    simBd.get_program_size = SimGetProgramSize;
+    simBd.get_erase_size = SimGetProgramSize;
+    simBd.is_in_range = SimIsInRange;
+    simBd.context = NULL;
+
+    (void)memset(&total, 0, sizeof(total));
+    for (pass = 0u; pass < PL_NUM_PASSES; pass++)
+    {
+        /* The key/value store is not reset safe in Simple mode */
+        isKvPass = (0u != pass);
+        for (i = 0u; i < (sizeof(plConfigs) / sizeof(plConfigs[0u])); i++)
+        {
+            if (isKvPass && (0u != plConfigs[i].simpleMode))
+            {
+                continue;
+            }
+            #if (CY_EM_EEPROM_FIXED_GEOMETRY == 1u)
+            /* Cy_Em_EEPROM_Init_BD() accepts only the fixed geometry */
+            if (!IsFixedGeometry(&plConfigs[i]))
+            {
+                continue;
+            }
+            #endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 1u) */
+            numRuns++;
+            (void)memset(&result, 0, sizeof(result));
+            RunConfig(&plConfigs[i], numOps, &result);
+            printf("%-22s %-3s operations %6u cuts %8u escapes %4u recovered %6u failures %u\n",
+                   plConfigs[i].name, isKvPass ? "kv" : "", (unsigned)result.operations,
+                   (unsigned)result.cuts, (unsigned)result.escapes, (unsigned)result.recovered,
+                   (unsigned)result.failures);
+            total.operations += result.operations;
+            total.cuts += result.cuts;
+            total.escapes += result.escapes;
+            total.failures += result.failures;
+        }
+    }
+
+    #if (CY_EM_EEPROM_FIXED_GEOMETRY == 0u)
+    /* Cy_Em_EEPROM_Migrate() cannot be used with the fixed geometry */
+    for (i = 0u; i < (sizeof(plMigrations) / sizeof(plMigrations[0u])); i++)
+    {
+        (void)memset(&result, 0, sizeof(result));
+        RunMigration(&plMigrations[i], (numOps / 10u) + 1u, &result);
+        printf("%-22s -> %-22s migrations %4u cuts %8u escapes %4u failures %u\n",
+               plMigrations[i].oldConfig.name, plMigrations[i].newConfig.name,
+               (unsigned)result.operations, (unsigned)result.cuts, (unsigned)result.escapes,
+               (unsigned)result.failures);
+        total.operations += result.operations;
+        total.cuts += result.cuts;
+        total.escapes += result.escapes;
+        total.failures += result.failures;
+    }
+    #endif /* (CY_EM_EEPROM_FIXED_GEOMETRY == 0u) */
+
+    if (0u == numRuns)
+    {
+        printf("no configuration matches the build\n");
+        total.failures++;
+    }
+
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    printf("total: %u power cuts in %.2f s (%.0f per second), %u escapes, %u failures\n",
+           (unsigned)total.cuts, seconds, (seconds > 0.0) ? ((double)total.cuts / seconds) : 0.0,
+           (unsigned)total.escapes, (unsigned)total.failures);
+
+    return (0u == total.failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}